@@ -12,15 +12,209 @@
 #include <cstdint>
 #include <initializer_list>
 #include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <cmath>
+#include <tuple>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "ThreadPool.hpp"
 
 
 
 namespace KozyLibrary {
 
+/*
+    how a node of a K_Tree stores its children.
+
+    dense   : one pointer per bucket, 2 to the power of k pointers per node. the fastest lookup, but only small for few properties.
+    sparse  : only the children, that exist, packed in the order of their buckets. the memory grows with the number of children.
+              up to 64 buckets a bit mask finds a child by a popcount, above that the buckets are binary searched.
+*/
+enum class K_TreeChildren : uint_fast8_t {
+    dense,
+    sparse
+};
+
+/*
+    a comparison of a Basic_K_Tree. it has PROPERTIES_CNT properties, 
+    get_Index(left, right) sets bit i, if left is "bigger" than right in property i, and 
+    is_bigger(i, left, right) compares only property i.
+*/
+template<typename ComparisonT, typename ElementT>
+concept K_TreeComparison = requires(const ElementT& e, uint_fast8_t property) {
+    { ComparisonT::PROPERTIES_CNT } -> std::convertible_to<uint_fast8_t>;
+    { ComparisonT::get_Index(e, e) } -> std::convertible_to<uint_fast64_t>;
+    { ComparisonT::is_bigger(property, e, e) } -> std::convertible_to<bool>;
+};
+
+/*
+    compares with an array of function pointers, one per property. each is called through its pointer.
+*/
+template<
+    typename ElementT, 
+    uint_fast8_t PROPERTIES, 
+    bool (* const (&compArr)[PROPERTIES]) (const ElementT&, const ElementT&)
+>
+struct K_TreeFunctionArray {
+    inline static constexpr uint_fast8_t PROPERTIES_CNT = PROPERTIES;
+    inline static constexpr auto COMPARE_FUNCTION_ARRAY = compArr;
+
+    static uint_fast64_t get_Index(const ElementT& left, const ElementT& right) noexcept {
+        uint_fast64_t res = 0;
+        for (uint_fast8_t cnt = 0; cnt != PROPERTIES_CNT; ++cnt){
+            res |= static_cast<uint_fast64_t>(compArr[cnt](left, right)) << cnt;
+        }
+        return res;
+    }
+
+    static bool is_bigger(uint_fast8_t property, const ElementT& left, const ElementT& right) noexcept {
+        return compArr[property](left, right);
+    }
+};
+
+/*
+    gives Basic_K_Tree the COMPARE_FUNCTION_ARRAY of its ComparisonT, if it has one, as K_Tree had it before it became an alias.
+*/
+template<typename ComparisonT>
+struct K_TreeCompareFunctions {};
+
+template<typename ComparisonT> requires requires { ComparisonT::COMPARE_FUNCTION_ARRAY; }
+struct K_TreeCompareFunctions<ComparisonT> {
+    inline static constexpr auto COMPARE_FUNCTION_ARRAY = ComparisonT::COMPARE_FUNCTION_ARRAY;
+};
+
+/*
+    compares with default constructible function objects, one per property. ComparatorT{}(left, right) returns true, if left is "bigger".
+    the calls are known at compile time, so they are inlined, and the bits are combined without branches.
+*/
+template<typename... ComparatorTs>
+struct K_TreeComparators {
+    inline static constexpr uint_fast8_t PROPERTIES_CNT = sizeof...(ComparatorTs);
+
+    template<typename ElementT>
+    static uint_fast64_t get_Index(const ElementT& left, const ElementT& right) noexcept {
+        return get_Index(left, right, std::index_sequence_for<ComparatorTs...>{});
+    }
+
+    template<typename ElementT>
+    static bool is_bigger(uint_fast8_t property, const ElementT& left, const ElementT& right) noexcept {
+        return is_bigger(property, left, right, std::index_sequence_for<ComparatorTs...>{});
+    }
+
+private:
+    template<typename ElementT, std::size_t... I>
+    static uint_fast64_t get_Index(const ElementT& left, const ElementT& right, std::index_sequence<I...>) noexcept {
+        return (0 | ... | (static_cast<uint_fast64_t>(static_cast<bool>(ComparatorTs{}(left, right))) << I));
+    }
+
+    template<typename ElementT, std::size_t... I>
+    static bool is_bigger(uint_fast8_t property, const ElementT& left, const ElementT& right, std::index_sequence<I...>) noexcept {
+        bool res = false;
+        static_cast<void>(((property == I && (res = ComparatorTs{}(left, right), true)) || ...));
+        return res;
+    }
+};
+
+/*
+    compares the keys, that the projections return, by >. a projection is anything std::invoke takes, e.g. &Point::x.
+    if all keys have the same arithmetic type, they are copied into two arrays and compared at once: 
+    with SSE2, up to 4 int32_t or float keys by one compare and a movemask, otherwise by a loop, that the compiler may vectorize.
+*/
+template<auto... PROJECTIONS>
+struct K_TreeProjections {
+    inline static constexpr uint_fast8_t PROPERTIES_CNT = sizeof...(PROJECTIONS);
+
+    template<typename ElementT>
+    static uint_fast64_t get_Index(const ElementT& left, const ElementT& right) noexcept {
+        using KeyT = std::remove_cvref_t<std::invoke_result_t<decltype(get_projection<0>()), const ElementT&>>;
+
+        if constexpr (std::is_arithmetic_v<KeyT> && (std::is_same_v<KeyT, std::remove_cvref_t<std::invoke_result_t<decltype(PROJECTIONS), const ElementT&>>> && ...)){
+#if defined(__SSE2__)
+            if constexpr (PROPERTIES_CNT <= 4 && (std::is_same_v<KeyT, std::int32_t> || std::is_same_v<KeyT, float>)){
+                alignas(16) KeyT lhs[4] = { std::invoke(PROJECTIONS, left)... };
+                alignas(16) KeyT rhs[4] = { std::invoke(PROJECTIONS, right)... };
+                if constexpr (std::is_same_v<KeyT, float>){
+                    return static_cast<uint_fast64_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_load_ps(lhs), _mm_load_ps(rhs))));
+                } else {
+                    const __m128i greater = _mm_cmpgt_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(lhs)), _mm_load_si128(reinterpret_cast<const __m128i*>(rhs)));
+                    return static_cast<uint_fast64_t>(_mm_movemask_ps(_mm_castsi128_ps(greater)));
+                }
+            }
+#endif
+            const KeyT lhs[PROPERTIES_CNT] = { std::invoke(PROJECTIONS, left)... };
+            const KeyT rhs[PROPERTIES_CNT] = { std::invoke(PROJECTIONS, right)... };
+            uint_fast64_t res = 0;
+            for (uint_fast8_t cnt = 0; cnt != PROPERTIES_CNT; ++cnt){
+                res |= static_cast<uint_fast64_t>(lhs[cnt] > rhs[cnt]) << cnt;
+            }
+            return res;
+        } else {
+            return get_Index(left, right, std::make_index_sequence<PROPERTIES_CNT>{});
+        }
+    }
+
+    template<typename ElementT>
+    static bool is_bigger(uint_fast8_t property, const ElementT& left, const ElementT& right) noexcept {
+        return is_bigger(property, left, right, std::make_index_sequence<PROPERTIES_CNT>{});
+    }
+
+private:
+    template<std::size_t I>
+    static constexpr auto get_projection() noexcept {
+        return std::get<I>(std::tuple{PROJECTIONS...});
+    }
+
+    template<typename ElementT, std::size_t... I>
+    static uint_fast64_t get_Index(const ElementT& left, const ElementT& right, std::index_sequence<I...>) noexcept {
+        return (0 | ... | (static_cast<uint_fast64_t>(std::invoke(get_projection<I>(), left) > std::invoke(get_projection<I>(), right)) << I));
+    }
+
+    template<typename ElementT, std::size_t... I>
+    static bool is_bigger(uint_fast8_t property, const ElementT& left, const ElementT& right, std::index_sequence<I...>) noexcept {
+        bool res = false;
+        static_cast<void>(((property == I && (res = std::invoke(get_projection<I>(), left) > std::invoke(get_projection<I>(), right), true)) || ...));
+        return res;
+    }
+};
+
+/*
+    a key extractor for a Basic_K_Tree, that caches a copy of the whole element in each node.
+    fits small elements, like points, that are compared by all of their members.
+*/
+struct K_TreeCopyKey {
+    template<typename ElementT>
+    ElementT operator()(const ElementT& e) const noexcept(std::is_nothrow_copy_constructible_v<ElementT>) {
+        return e;
+    }
+};
+
+/*
+    the key, that a Basic_K_Tree compares: the element itself if KeyExtractorT is void, otherwise the result of KeyExtractorT.
+*/
+template<typename ElementT, typename KeyExtractorT>
+struct K_TreeKey {
+    using type = std::remove_cvref_t<std::invoke_result_t<const KeyExtractorT&, const ElementT&>>;
+    inline static constexpr bool IS_NOTHROW = std::is_nothrow_invocable_v<const KeyExtractorT&, const ElementT&>;
+};
+template<typename ElementT>
+struct K_TreeKey<ElementT, void> {
+    using type = ElementT;
+    inline static constexpr bool IS_NOTHROW = true;
+};
+
 /*
 * DESCRIPTION *
 
-A Tree structure, that stores Elements in Nodes according to an array of comparison functions. 
+A Tree structure, that stores Elements in Nodes according to a comparison per property. 
 A node has 2 to the power of k branches for which k is the count of dimensions/properties that elements are to be differentiated.
 The tree does not take ownership of the elements.
 
@@ -33,94 +227,358 @@ Assumptions:
 
 ElementT			: The underlying Element Type.
 
-PROPERTIES_CNT		: How many distinguishable properties/dimensions/features an Element has. 
+ComparisonT			: decides if a specific value of a property of the left object is semantically "bigger" than the rights respective one. 
+                    left > right == true
+					ComparisonT::PROPERTIES_CNT is how many distinguishable properties/dimensions/features an Element has. 
 					For Example, if you store students only according to their points earned, then the Element has only one property to sort by.
+					see K_TreeComparison. K_TreeComparators and K_TreeProjections are inlined, K_TreeFunctionArray calls function pointers.
 
-compArr			: decides if a specific value of a property of the left object is semantically "bigger" than the rights respective one. 
-                    left > right == true
+CHILDREN			: how a node stores its children, see K_TreeChildren.
+
+KeyExtractorT		: void, or a default constructible function object, that returns the key of an element, see K_TreeCopyKey.
+					a node stores the key of its element next to its children, and ComparisonT compares keys instead of elements, 
+					so that the way down the tree only reads the nodes. the key has to be trivially destructible.
+					get_range(), find_Node() and the like take elements and compare their keys. nearest() still reads the elements for the distance.
+
+K_Tree<ElementT, PROPERTIES_CNT, compArr> is a Basic_K_Tree, that compares with the array compArr of PROPERTIES_CNT function pointers.
+It is an alias template, so it can neither be forward declared as a class nor be specialized.
 
 
 * OTHER *
 
 Node				: represents a pointer to an existing element. If the object is destroyed, then this node is in an invalid state.
 
+The nodes are allocated from slabs, that hold many nodes next to each other, and that are only released all at once by the destructor.
+reserve() allocates one slab for all nodes to come.
+
+Each node knows its parent, so an Iterator is only two pointers and walks the tree without allocating.
+for_each() visits the same nodes in the same order without an Iterator.
+
+get_range(), for_range() and count_range() find the elements inside of a box, that is given by its smallest and its biggest corner.
+They skip every bucket, that cannot hold an element of the box, so they visit little more than the elements inside of it and the nodes at its border.
+
+nearest() finds the k elements closest to a query. The tree only knows how to compare elements, so the caller gives the distance
+and a lower bound of it per property, that lets nearest() skip the buckets, that are too far away.
+
+Pushing sorted or clustered elements one after another makes long chains. make_Balanced() builds the tree from all elements at once instead,
+with the median of one property as the element of each node, so that the tree is O(log n) deep. 
+Given a ThreadPool, it builds big subtrees in parallel.
+
+The children of a node are stored as CHILDREN says. Basic_K_Tree uses dense nodes for up to 4 properties and sparse ones above that by default,
+K_Tree uses dense nodes by default.
+
+remove_Node() and remove_element() take an element out of the tree. A leaf is simply unlinked, 
+otherwise the subtree below the removed node is rebuilt balanced from its remaining elements on the same nodes.
+set_rebalancing() makes push() rebuild the subtree of a scapegoat, if a new node is too deep, so that the tree stays O(log n) deep
+under a long mix of pushes and removals.
+Both move elements between nodes: Node references and Iterators into the changed subtree become invalid.
+
+push_batch(), find_batch(), for_range_batch() and count_range_batch() handle many elements or boxes in one walk of the tree,
+so that the top levels are read once per batch, and prefetch the nodes, that come next.
+
 
 */
 template<
 	typename ElementT, 
-	uint_fast8_t PROPERTIES_CNT, 
-	bool (* const (&compArr)[PROPERTIES_CNT]) (const ElementT&, const ElementT&)
+	typename ComparisonT,
+	K_TreeChildren CHILDREN = (ComparisonT::PROPERTIES_CNT <= 4)? K_TreeChildren::dense : K_TreeChildren::sparse,
+	typename KeyExtractorT = void
 >
-class K_Tree{
+requires K_TreeComparison<ComparisonT, typename K_TreeKey<ElementT, KeyExtractorT>::type>
+class Basic_K_Tree : public K_TreeCompareFunctions<ComparisonT>{
 public:
 
+inline static constexpr uint_fast8_t PROPERTIES_CNT			= ComparisonT::PROPERTIES_CNT;
 inline static constexpr uint_fast8_t PROPERTIES				= PROPERTIES_CNT;
-inline static constexpr auto COMPARE_FUNCTION_ARRAY		    = compArr;
 inline static constexpr auto BUCKET_CNT 	                = (PROPERTIES_CNT <= 7) ? (static_cast<uint_fast8_t>(1) << PROPERTIES_CNT) : 
                                                             (PROPERTIES_CNT <= 15) ? (static_cast<uint_fast16_t>(1) << PROPERTIES_CNT): (static_cast<uint_fast32_t>(1) << PROPERTIES_CNT);
 
 using BUCKET_TYPE = std::remove_cv_t<decltype(BUCKET_CNT)>;
+using Comparison = ComparisonT;
+using KeyT = typename K_TreeKey<ElementT, KeyExtractorT>::type;
+
+inline static constexpr bool IS_CACHING_KEYS                = !std::is_void_v<KeyExtractorT>;
+
+/*
+    the key of an element: a reference to the element itself, or a new key, if keys are cached.
+*/
+static decltype(auto) get_Key(const ElementT& obj) noexcept(K_TreeKey<ElementT, KeyExtractorT>::IS_NOTHROW) {
+    if constexpr (IS_CACHING_KEYS){
+        return KeyT(KeyExtractorT{}(obj));
+    } else {
+        return static_cast<const ElementT&>(obj);
+    }
+}
+
+inline static constexpr K_TreeChildren CHILD_STORAGE        = CHILDREN;
 
 struct Node;
 
 
     template<typename IteratorType>
-    K_Tree(IteratorType arr, uint_fast32_t cnt)
+    Basic_K_Tree(IteratorType arr, uint_fast32_t cnt)
     {
         root = nullptr;
+        reserve(cnt);
         while (cnt-- != 0){
             push(*arr);
             ++arr;
         }
     }
 
-    K_Tree(std::initializer_list<std::reference_wrapper<ElementT>> l){
+    Basic_K_Tree(std::initializer_list<std::reference_wrapper<ElementT>> l){
         root = nullptr;
+        reserve(l.size());
         for (auto& e : l){
             push(e);
         }
     }
 
-    K_Tree():
+    Basic_K_Tree():
         root(nullptr)
     {
 
     }
 
-    ~K_Tree() {
-       if (!is_empty()){
-            for (Iterator iter = this->begin(), end = this->end(); iter != end; ){
-                const Node& temp = *iter;
-                ++iter;
-                delete &temp;
-            }
+    Basic_K_Tree(const Basic_K_Tree&) = delete;
+    Basic_K_Tree& operator=(const Basic_K_Tree&) = delete;
+
+    Basic_K_Tree(Basic_K_Tree&& mv) noexcept:
+        root(std::exchange(mv.root, nullptr)),
+        arena(std::move(mv.arena))
+    {
+
+    }
+
+    Basic_K_Tree& operator=(Basic_K_Tree&& mv) noexcept {
+        if (this != &mv){
+            root = std::exchange(mv.root, nullptr);
+            arena = std::move(mv.arena);
         }
+        return *this;
     }
 
+    /*
+    releases all slabs at once, without visiting the nodes.
+    */
+    ~Basic_K_Tree() = default;
+
+    /*
+    builds a tree of cnt elements, that is O(log n) deep:
+    the element of a node is the median of its subtree in one property, the property changes from level to level.
+    so a child holds at most half of the elements of its parent, unless many elements are equal in that property.
+
+    takes O(n log n) comparisons and one allocation for all nodes.
+    */
+    template<typename IteratorType>
+    static Basic_K_Tree make_Balanced(IteratorType arr, std::size_t cnt) {
+        Basic_K_Tree res;
+        res.root = BalancedBuild(res, arr, cnt, nullptr).run(nullptr);
+        return res;
+    }
+
+    /*
+    like make_Balanced() above, but subtrees of more than PARALLEL_BUILD_GRAIN elements are built by the workers of pool, while the calling thread helps.
+    builds on the calling thread alone, if pool is not running.
+    */
+    template<typename IteratorType>
+    static Basic_K_Tree make_Balanced(IteratorType arr, std::size_t cnt, ThreadPool& pool) {
+        Basic_K_Tree res;
+        res.root = BalancedBuild(res, arr, cnt, pool.is_running()? &pool : nullptr).run(nullptr);
+        return res;
+    }
+
+    inline static constexpr std::size_t PARALLEL_BUILD_GRAIN = std::size_t(1) << 13;
+
+    /*
+    returns the node of obj. with rebalancing, that node stays valid only until the next push() or removal.
+    */
     Node& push(ElementT& obj) noexcept {
-        return internal_push(obj, &root);
+        return internal_push(obj);
     }
 
-    K_Tree& operator<<(ElementT& obj) noexcept {
+    Basic_K_Tree& operator<<(ElementT& obj) noexcept {
         push(obj);
         return *this;
     }
 
     template<typename IteratorType>
     void push_array(IteratorType arr, uint_fast32_t cnt) {
+        reserve(get_nodeCnt() + cnt);
         while (cnt-- != 0){
             push(*arr);
             ++arr;
         }
     }
 
-    struct Node{
+    /*
+    pushes cnt elements and builds the same tree as push_array().
+    the elements are routed as one block: each node splits the block by the buckets of its elements and hands each part on to its child,
+    so that a node is read once per block instead of once per element.
+    an element, that is alone in its subtree, descends in step with up to BATCH_LANES others, and the next node of each is prefetched,
+    so that their cache misses overlap.
+    with rebalancing, the elements are pushed one after another.
+    */
+    template<typename IteratorType>
+    void push_batch(IteratorType arr, std::size_t cnt) {
+        if (is_rebalancing() || cnt == 0){
+            push_array(arr, static_cast<uint_fast32_t>(cnt));
+            return;
+        }
+        reserve(get_nodeCnt() + cnt);
+        BatchRoute<true> route(*this);
+        for (std::size_t pos = 0; pos != cnt; ++pos, ++arr){
+            route.add(*arr);
+        }
+        route.run();
+    }
+
+    /*
+    find_Node() for cnt elements at once, routed like push_batch(). the node of queries[i] is at position i, nullptr if there is none.
+    */
+    template<typename IteratorType>
+    std::vector<Node*> find_batch(IteratorType queries, std::size_t cnt) const {
+        BatchRoute<false> route(const_cast<Basic_K_Tree&>(*this));
+        for (std::size_t pos = 0; pos != cnt; ++pos, ++queries){
+            route.add(*queries);
+        }
+        route.run();
+        return route.take_Found();
+    }
+
+    inline static constexpr std::size_t BATCH_LANES = 16;
+
+    /*
+    the children of a node are walked by their position, from 0 to get_childEnd(), in the order of their buckets.
+    get_childAt() is nullptr for the positions of missing children of dense nodes.
+    */
+    struct DenseChildren{
+
+        BUCKET_TYPE get_childEnd() const noexcept {
+            return BUCKET_CNT;
+        }
+
+        Node* get_childAt(BUCKET_TYPE pos) const noexcept {
+            return children[pos];
+        }
+
+        BUCKET_TYPE get_bucketAt(BUCKET_TYPE pos) const noexcept {
+            return pos;
+        }
+
+        Node* get_child(BUCKET_TYPE bucket) const noexcept {
+            return children[bucket];
+        }
+
+        /*
+        UB if child is not a child of this node.
+        */
+        BUCKET_TYPE get_positionOf(const Node* child) const noexcept {
+            BUCKET_TYPE pos = 0;
+            while (children[pos] != child){
+                ++pos;
+            }
+            return pos;
+        }
+
+        Node* children[BUCKET_CNT]{};
+    };
+
+    /*
+    packed points to a block of 2 to the power of sizeClass children, followed by their buckets.
+    */
+    struct SparseChildren{
+        inline static constexpr bool HAS_MASK = (BUCKET_CNT <= 64);
+
+        struct NoMask{};
+
+        BUCKET_TYPE get_childEnd() const noexcept {
+            return childCnt;
+        }
+
+        Node* get_childAt(BUCKET_TYPE pos) const noexcept {
+            return packed[pos];
+        }
+
+        BUCKET_TYPE get_bucketAt(BUCKET_TYPE pos) const noexcept {
+            return get_blockBuckets(packed, sizeClass)[pos];
+        }
+
+        Node* get_child(BUCKET_TYPE bucket) const noexcept {
+            if constexpr (HAS_MASK){
+                return ((mask >> bucket) & 1)? packed[get_bucketPosition(bucket)] : nullptr;
+            } else {
+                const BUCKET_TYPE pos = get_bucketPosition(bucket);
+                return (pos != childCnt && get_bucketAt(pos) == bucket)? packed[pos] : nullptr;
+            }
+        }
+
+        /*
+        UB if child is not a child of this node.
+        */
+        BUCKET_TYPE get_positionOf(const Node* child) const noexcept {
+            BUCKET_TYPE pos = 0;
+            while (packed[pos] != child){
+                ++pos;
+            }
+            return pos;
+        }
+
+        /*
+        the position of the child in bucket, or where it would be inserted.
+        */
+        BUCKET_TYPE get_bucketPosition(BUCKET_TYPE bucket) const noexcept {
+            if constexpr (HAS_MASK){
+                return static_cast<BUCKET_TYPE>(std::popcount(static_cast<uint_fast64_t>(mask & ((uint_fast64_t(1) << bucket) - 1))));
+            } else {
+                if (!packed){
+                    return 0;
+                }
+                const BUCKET_TYPE* const buckets = get_blockBuckets(packed, sizeClass);
+                return static_cast<BUCKET_TYPE>(std::lower_bound(buckets, buckets + childCnt, bucket) - buckets);
+            }
+        }
+
+        /*
+        how many child pointers a block of sizeClass takes, including its buckets.
+        */
+        inline static constexpr std::size_t get_blockSize(uint_fast8_t sizeClass) noexcept {
+            const std::size_t capacity = std::size_t(1) << sizeClass;
+            return capacity + (capacity*sizeof(BUCKET_TYPE) + sizeof(Node*) - 1)/sizeof(Node*);
+        }
+
+        static BUCKET_TYPE* get_blockBuckets(Node* const* block, uint_fast8_t sizeClass) noexcept {
+            return reinterpret_cast<BUCKET_TYPE*>(const_cast<Node**>(block) + (std::size_t(1) << sizeClass));
+        }
+
+        Node** packed{nullptr};
+        BUCKET_TYPE childCnt{0};
+        uint_fast8_t sizeClass{0};
+        [[no_unique_address]] std::conditional_t<HAS_MASK, uint_fast64_t, NoMask> mask{};
+    };
+
+    using ChildStorage = std::conditional_t<CHILDREN == K_TreeChildren::dense, DenseChildren, SparseChildren>;
+
+    struct NoKey{};
 
-        Node(ElementT* v):
-            value(v)
+    struct Node : ChildStorage{
+
+        Node(ElementT* v, Node* p = nullptr):
+            value(v),
+            parent(p),
+            key(make_Key(*v))
         {
-            for (BUCKET_TYPE cnt = 0; cnt != BUCKET_CNT; ++cnt){
-                children[cnt] = nullptr;
+
+        }
+
+        /*
+        the key, that this node is compared by. only reads the node, if keys are cached.
+        */
+        const KeyT& get_Key() const noexcept {
+            if constexpr (IS_CACHING_KEYS){
+                return key;
+            } else {
+                return *value;
             }
         }
 
@@ -139,83 +597,47 @@ struct Node;
         }
 
         ElementT* value;
-        Node* children[BUCKET_CNT];
+        Node* parent;
+        [[no_unique_address]] std::conditional_t<IS_CACHING_KEYS, KeyT, NoKey> key;
+
+    private:
+        static auto make_Key(const ElementT& obj) {
+            if constexpr (IS_CACHING_KEYS){
+                return Basic_K_Tree::get_Key(obj);
+            } else {
+                return NoKey{};
+            }
+        }
 
 
     };
 
+    /*
+    visits the nodes depth first, a node before its children and the children in the order of their buckets.
+    only the nodes below the node, that the Iterator started at, are visited.
+    */
     class Iterator{
     public:
 
-        Iterator(Node* cur, Iterator* next = nullptr):
+        Iterator(Node* cur, const Node* first = nullptr) noexcept:
             current(cur),
-            nextBranch(next)
-        {
-
-        }
-
-        Iterator(const Iterator& cpy):
-            current(cpy.current)
+            top(first? first : cur)
         {
-            if (cpy.nextBranch){
-                nextBranch = new Iterator(*cpy.nextBranch);
-            } else {
-                nextBranch = nullptr;
-            }
-        }
-
-        ~Iterator() {
-            delete nextBranch;
-        }
-
-        Iterator& operator=(const Iterator& rhs) noexcept {
-            if (this != &rhs){
-                current = rhs.current;
-                delete nextBranch;
-                if (rhs.nextBranch){
-                    nextBranch = new Iterator(*rhs.nextBranch);
-                } else {
-                    nextBranch = nullptr;
-                }
-            }
 
-            return *this;
         }
 
         /*
         User is responsible for valid Iterator. Undefined behavior, if the iterator points to a nullptr Node. 
         */
-        inline Iterator& operator++() {
+        inline Iterator& operator++() noexcept {
             return const_cast<Iterator&>(++static_cast<const Iterator&>(*this));
         }
-        const Iterator& operator++() const {
-            for (Node ** childIter = current->children, ** endIter = childIter + BUCKET_CNT; childIter != endIter; ++childIter){ // search for first valid child of current Node
-                if (*childIter){ // true : valid child of current Node found
-                    while (--endIter != childIter){ // look for new branches. go in reverse order from end to child
-                        if (*endIter){ // true : new branch found. endIter is pointing to a sibling Node
-                            nextBranch = new Iterator(*endIter, nextBranch); // update nextBranch
-                        }
-                    }
-                    current = *childIter;
-                    return *this;
-                }
-            } // current has no children
-
-            if (nextBranch){ // jump to next branch
-                const Iterator* const temp = nextBranch;
-                current = temp->current;
-                nextBranch = temp->nextBranch;
-                (*temp).nextBranch = nullptr;
-                delete temp; 
-
-            } else { // there are no next nodes
-                current = nullptr;
-            }
-
+        const Iterator& operator++() const noexcept {
+            current = get_nextNode(current, top);
             return *this;
         }
 
-        Iterator operator++(int) const {
+        Iterator operator++(int) const noexcept {
             Iterator old(*this);
             ++(*this);
             return old;
@@ -242,13 +664,6 @@ struct Node;
             return **current;
         }
 
-        Iterator* get_nextBranch() noexcept {
-            return nextBranch;
-        }
-        const Iterator* get_nextBranch() const noexcept {
-            return nextBranch;
-        }
-
         bool has_Node() const noexcept {
             return (current);
         }
@@ -256,7 +671,7 @@ struct Node;
     private:
 
         mutable Node* current;
-        mutable Iterator* nextBranch;
+        const Node* top;
 
     };
 
@@ -271,28 +686,121 @@ struct Node;
         return !(root);
     }
 
-    //ElementT& remove_Node(Node* node) {
-        
-    //}
-
-    //ElementT& remove_element(const ElementT& obj) {
-        
-    //}
+    std::size_t get_nodeCnt() const noexcept {
+        return arena.nodeCnt;
+    }
 
     /*
-    gets the first node of an element, which is smaller than obj but bigger than all elements that are smaller than obj.
+    the number of nodes on the longest path from the root to a leaf. 0 if the tree is empty.
+    */
+    std::size_t get_height() const {
+        std::size_t res = 0;
+        std::vector<std::pair<const Node*, std::size_t>> stack;
+        if (root){
+            stack.emplace_back(root, 1);
+        }
+        while (!stack.empty()){
+            const auto [node, depth] = stack.back();
+            stack.pop_back();
+            res = std::max(res, depth);
+            for (BUCKET_TYPE pos = 0, end = node->get_childEnd(); pos != end; ++pos){
+                if (const Node* const child = node->get_childAt(pos)){
+                    stack.emplace_back(child, depth + 1);
+                }
+            }
+        }
+        return res;
+    }
 
-    case: there is an Element smaller than obj
-        return a node to that
+    /*
+    how many nodes fit, before another slab has to be allocated.
+    */
+    std::size_t get_capacity() const noexcept {
+        return arena.nodeCnt + arena.freeNodeCnt + static_cast<std::size_t>(arena.slabEnd - arena.slabPos);
+    }
 
-    case: there is no smaller Element
-        return smallest
+    /*
+    allocates one slab, so that nodeCnt nodes fit without further allocations.
+    the rest of the current slab is left unused, if it is too small.
+    */
+    void reserve(std::size_t nodeCnt) {
+        if (nodeCnt > get_capacity()){
+            arena.add_Slab(nodeCnt - arena.nodeCnt - arena.freeNodeCnt);
+        }
+    }
 
-    case: there is no bigger
-        return the biggest
+    /*
+    returns the node of the element, that equals obj in every property, or nullptr. O(depth).
+    */
+    Node* find_Node(const ElementT& obj) noexcept {
+        const KeyT& key = get_Key(obj);
+        for (Node* node = root; node != nullptr; ){
+            const BUCKET_TYPE bucket = get_ComparisonIndex(node->get_Key(), key);
+            if (bucket == 0 && get_ComparisonIndex(key, node->get_Key()) == 0){
+                return node;
+            }
+            node = node->get_child(bucket);
+        }
+        return nullptr;
+    }
 
-    case: there are no elements 
-        Undefined Behavior
+    /*
+    takes the element of node out of the tree and returns it. the node is reused by later pushes.
+    a leaf is unlinked in O(1), otherwise the subtree below node is rebuilt balanced without it, in O(s log s) for s nodes in that subtree.
+    UB if node is not a node of this tree.
+    */
+    ElementT& remove_Node(Node& node) {
+        ElementT& res = *node;
+        if (!has_Children(node)){
+            replace_Child(node, nullptr);
+            release_Children(node);
+            arena.free_Node(&node);
+        } else {
+            rebuild_Subtree(node, &node);
+        }
+        return res;
+    }
+
+    /*
+    takes the element, that equals obj in every property, out of the tree and returns it. nullptr if there is none.
+    */
+    ElementT* remove_element(const ElementT& obj) {
+        Node* const node = find_Node(obj);
+        return node? &remove_Node(*node) : nullptr;
+    }
+
+    /*
+    a scapegoat rebalancing: if push() puts a node deeper than log(n) to the base 1/alpha + 1,
+    the lowest ancestor, that has a child with more than alpha times its own nodes, is rebuilt balanced.
+    alpha is between 0.5 and 1: smaller keeps the tree shallower, but rebuilds more often.
+    */
+    void set_rebalancing(double alpha = 0.7) noexcept {
+        rebalanceAlpha = alpha;
+        rebalanceLogBase = -std::log(alpha);
+    }
+
+    void disable_rebalancing() noexcept {
+        rebalanceAlpha = 0;
+    }
+
+    bool is_rebalancing() const noexcept {
+        return rebalanceAlpha != 0;
+    }
+
+    /*
+    gets the first node of an element, which is smaller than obj but bigger than all elements that are smaller than obj.
+
+    case: there is an Element smaller than obj
+        return a node to that
+
+    case: there is no smaller Element
+        return smallest
+
+    case: there is no bigger
+        return the biggest
+
+    case: there are no elements 
+        Undefined Behavior
 
 
     *//*
@@ -315,11 +823,226 @@ struct Node;
     inline Node& find(const ElementT& obj) {return find(obj, root);}
 */
 
-//    Iterator get_range_shuffled(const ElementT& lhs, const ElementT& rhs) {
+private:
+
+    /*
+    a key, that is kept apart from the nodes, like a corner of a range: a copy of the key, if keys are cached, otherwise the element.
+    */
+    using KeyHolder = std::conditional_t<IS_CACHING_KEYS, KeyT, const ElementT*>;
+
+    static KeyHolder hold_Key(const ElementT& obj) {
+        if constexpr (IS_CACHING_KEYS){
+            return get_Key(obj);
+        } else {
+            return &obj;
+        }
+    }
+
+    static const KeyT& get_HeldKey(const KeyHolder& holder) noexcept {
+        if constexpr (IS_CACHING_KEYS){
+            return holder;
+        } else {
+            return *holder;
+        }
+    }
+
+public:
+
+    /*
+    visits the nodes, whose elements are inside of the box from lhs to rhs, including both, in the order of the Iterator.
+    only the buckets, that can hold such elements, are entered.
+    */
+    class RangeIterator{
+    public:
+
+        RangeIterator(Node* cur, const ElementT& lhs, const ElementT& rhs):
+            current(cur),
+            top(cur),
+            low(hold_Key(lhs)),
+            high(hold_Key(rhs))
+        {
+            if (current && !is_inRange(current->get_Key(), get_HeldKey(low), get_HeldKey(high))){
+                ++(*this);
+            }
+        }
+
+        RangeIterator() noexcept:
+            current(nullptr),
+            top(nullptr),
+            low(),
+            high()
+        {
+
+        }
+
+        /*
+        Undefined behavior, if the iterator points to a nullptr Node.
+        */
+        RangeIterator& operator++() noexcept {
+            do {
+                current = get_nextRangeNode(current, top, get_HeldKey(low), get_HeldKey(high));
+            } while (current && !is_inRange(current->get_Key(), get_HeldKey(low), get_HeldKey(high)));
+            return *this;
+        }
+
+        RangeIterator operator++(int) noexcept {
+            RangeIterator old(*this);
+            ++(*this);
+            return old;
+        }
+
+        constexpr bool operator==(const RangeIterator& rhs) const noexcept {
+            return current == rhs.current;
+        }
+        inline constexpr bool operator!=(const RangeIterator& rhs) const noexcept {
+            return !((*this) == rhs);
+        }
+
+        Node& operator*() noexcept {
+            return *current;
+        }
+        const Node& operator*() const noexcept {
+            return *current;
+        }
+
+        ElementT& operator->() noexcept {
+            return **current;
+        }
+        const ElementT& operator->() const noexcept { 
+            return **current;
+        }
+
+        bool has_Node() const noexcept {
+            return (current);
+        }
+
+    private:
 
-//    }
+        Node* current;
+        const Node* top;
+        KeyHolder low;
+        KeyHolder high;
 
-    Iterator begin(Node* node) {
+    };
+
+    struct Range{
+        RangeIterator first;
+
+        RangeIterator begin() const noexcept {
+            return first;
+        }
+        RangeIterator end() const noexcept {
+            return RangeIterator();
+        }
+    };
+
+    /*
+    the elements inside of the box from lhs to rhs, including both, for a range-based for loop.
+    lhs and rhs have to outlive the Range. The Range is empty, if lhs is bigger than rhs in any property.
+    */
+    Range get_range(const ElementT& lhs, const ElementT& rhs) {
+        return Range{RangeIterator(root, lhs, rhs)};
+    }
+
+    /*
+    calls func(element) for every element inside of the box from lhs to rhs, including both.
+    */
+    template<typename FuncT>
+    void for_range(const ElementT& lhs, const ElementT& rhs, FuncT&& func) {
+        const KeyT& low = get_Key(lhs);
+        const KeyT& high = get_Key(rhs);
+        for (Node* node = root; node != nullptr; node = get_nextRangeNode(node, root, low, high)){
+            if (is_inRange(node->get_Key(), low, high)){
+                func(**node);
+            }
+        }
+    }
+
+    std::size_t count_range(const ElementT& lhs, const ElementT& rhs) const {
+        const KeyT& low = get_Key(lhs);
+        const KeyT& high = get_Key(rhs);
+        std::size_t cnt = 0;
+        for (Node* node = root; node != nullptr; node = get_nextRangeNode(node, root, low, high)){
+            cnt += is_inRange(node->get_Key(), low, high)? 1 : 0;
+        }
+        return cnt;
+    }
+
+    /*
+    calls func(i, element) for every element inside of the box from lows[i] to highs[i], for each of the cnt boxes.
+    all boxes walk the tree together: a node is read once for all boxes, that reach it, 
+    and each child is handed the boxes, that can hold elements in its bucket.
+    */
+    template<typename IteratorType, typename FuncT>
+    void for_range_batch(IteratorType lows, IteratorType highs, std::size_t cnt, FuncT&& func) {
+        walk_RangeBatch(root, lows, highs, cnt, func);
+    }
+
+    /*
+    count_range() for cnt boxes at once, see for_range_batch(). the count of the box from lows[i] to highs[i] is at position i.
+    */
+    template<typename IteratorType>
+    std::vector<std::size_t> count_range_batch(IteratorType lows, IteratorType highs, std::size_t cnt) const {
+        std::vector<std::size_t> res(cnt, 0);
+        walk_RangeBatch(root, lows, highs, cnt, [&res](std::size_t box, ElementT&){ ++res[box]; });
+        return res;
+    }
+
+    template<typename DistanceT>
+    struct Neighbour{
+        Node* node;
+        DistanceT distance;
+    };
+
+    /*
+    returns the k nodes, whose elements are closest to query, the closest first. fewer, if the tree has less than k nodes.
+
+    distance(query, element)        : the distance between two elements. any type, that is ordered by <, and whose value initialization is no bigger than any distance.
+    bound(property, query, element) : a lower bound of distance(query, other) for every other, that lies on the other side of element
+                                      than query in the property. e.g. |query.x - element.x| for the euclidean distance and property x.
+
+    buckets, that cannot hold an element closer than the k closest found so far, are not entered.
+    the k closest are kept in a max-heap, so that the farthest of them is replaced in O(log k).
+    */
+    template<typename DistanceFuncT, typename BoundFuncT>
+    auto nearest(const ElementT& query, std::size_t k, DistanceFuncT&& distance, BoundFuncT&& bound) const {
+        NearestSearch<DistanceFuncT, BoundFuncT> search(k, distance, bound);
+        search.run(root, query);
+        return search.take_Result();
+    }
+
+    /*
+    like nearest(), for cnt queries at once. the result of queries[i] is at position i.
+    the queries are answered in the order of the buckets, that they fall into, so that close queries follow each other
+    and find the nodes near them still in the cache. the buffers of the search are reused.
+    */
+    template<typename IteratorType, typename DistanceFuncT, typename BoundFuncT>
+    auto nearest_batch(IteratorType queries, std::size_t cnt, std::size_t k, DistanceFuncT&& distance, BoundFuncT&& bound) const {
+        using SearchT = NearestSearch<DistanceFuncT, BoundFuncT>;
+        std::vector<std::vector<typename SearchT::NeighbourT>> res(cnt);
+
+        struct Query{
+            uint_fast64_t key;
+            std::size_t pos;
+            const ElementT* element;
+        };
+        std::vector<Query> order;
+        order.reserve(cnt);
+        for (std::size_t pos = 0; pos != cnt; ++pos, ++queries){
+            const ElementT& element = *queries;
+            order.push_back({get_pathKey(element), pos, &element});
+        }
+        std::sort(order.begin(), order.end(), [](const Query& lhs, const Query& rhs){ return lhs.key < rhs.key; });
+
+        SearchT search(k, distance, bound);
+        for (const Query& e : order){
+            search.run(root, *e.element);
+            res[e.pos] = search.take_Result();
+        }
+        return res;
+    }
+
+    Iterator begin(Node* node) noexcept {
         return Iterator(node);
     }
     inline Iterator begin() {return this->begin(root);}
@@ -328,22 +1051,204 @@ struct Node;
     exclusive end
     */
     Iterator end(Node* node = nullptr) noexcept {
-        return Iterator(node, nullptr);
+        return Iterator(node);
+    }
+
+    /*
+    calls func(element) for every element below node, in the order of the Iterator.
+    */
+    template<typename FuncT>
+    static void for_each(Node* node, FuncT&& func) {
+        for (const Node* const top = node; node != nullptr; node = get_nextNode(node, top)){
+            func(**node);
+        }
     }
+    template<typename FuncT>
+    inline void for_each(FuncT&& func) {for_each(root, func);}
+
+    template<typename FuncT>
+    static void for_each(const Node* node, FuncT&& func) {
+        for (const Node* const top = node; node != nullptr; node = get_nextNode(const_cast<Node*>(node), top)){
+            func(**node);
+        }
+    }
+    template<typename FuncT>
+    inline void for_each(FuncT&& func) const {for_each(static_cast<const Node*>(root), func);}
 
 
 
 private:
 
+    /*
+    hands out nodes one after another from the current slab. a new slab is twice as big as the one before, up to MAX_SLAB_SIZE nodes.
+    the blocks of sparse children come from slabs of their own. a block, that a node outgrew, is kept in a free list of its size.
+    Node is trivially destructible, so the slabs are released without visiting the nodes.
+    */
+    struct NodeArena {
+        inline static constexpr std::size_t MIN_SLAB_SIZE = 64;
+        inline static constexpr std::size_t MAX_SLAB_SIZE = std::size_t(1) << 16;
+        inline static constexpr std::size_t CHILD_SLAB_SIZE = std::size_t(1) << 12;
+
+        template<typename T>
+        struct Slab {
+            T* nodes;
+            std::size_t cnt;
+        };
+
+        NodeArena() = default;
+
+        NodeArena(NodeArena&& mv) noexcept {
+            swap(mv);
+        }
+
+        NodeArena& operator=(NodeArena&& mv) noexcept {
+            if (this != &mv){
+                release();
+                swap(mv);
+            }
+            return *this;
+        }
+
+        ~NodeArena() {
+            release();
+        }
+
+        void swap(NodeArena& other) noexcept {
+            std::swap(slabs, other.slabs);
+            std::swap(slabPos, other.slabPos);
+            std::swap(slabEnd, other.slabEnd);
+            std::swap(nextSlabSize, other.nextSlabSize);
+            std::swap(nodeCnt, other.nodeCnt);
+            std::swap(childSlabs, other.childSlabs);
+            std::swap(childPos, other.childPos);
+            std::swap(childEnd, other.childEnd);
+            std::swap(freeBlocks, other.freeBlocks);
+            std::swap(freeNodes, other.freeNodes);
+            std::swap(freeNodeCnt, other.freeNodeCnt);
+        }
+
+        /*
+        cnt nodes next to each other, that are constructed by the caller. UB if the tree is not empty.
+        */
+        Node* allocate_Block(std::size_t cnt) {
+            if (static_cast<std::size_t>(slabEnd - slabPos) < cnt){
+                add_Slab(cnt);
+            }
+            Node* const res = slabPos;
+            slabPos += cnt;
+            nodeCnt += cnt;
+            return res;
+        }
+
+        Node* allocate(ElementT* value, Node* parent) {
+            ++nodeCnt;
+            if (freeNodes){
+                Node* const res = freeNodes;
+                freeNodes = res->parent;
+                --freeNodeCnt;
+                return ::new (static_cast<void*>(res)) Node(value, parent);
+            }
+            if (slabPos == slabEnd){
+                add_Slab(nextSlabSize);
+            }
+            return ::new (static_cast<void*>(slabPos++)) Node(value, parent);
+        }
+
+        /*
+        keeps node for the next allocate(), linked by its parent.
+        */
+        void free_Node(Node* node) noexcept {
+            node->parent = freeNodes;
+            freeNodes = node;
+            ++freeNodeCnt;
+            --nodeCnt;
+        }
+
+        void add_Slab(std::size_t cnt) {
+            static_assert(std::is_trivially_destructible_v<Node>);
+
+            slabs.reserve(slabs.size() + 1);
+            Node* const nodes = std::allocator<Node>().allocate(cnt);
+            slabs.push_back({nodes, cnt});
+            slabPos = nodes;
+            slabEnd = nodes + cnt;
+            if (nextSlabSize < MAX_SLAB_SIZE){
+                nextSlabSize *= 2;
+            }
+        }
+
+        /*
+        a block for the sparse children of one node, see SparseChildren.
+        */
+        Node** allocate_Children(uint_fast8_t sizeClass) {
+            if (Node** const res = freeBlocks[sizeClass]){
+                freeBlocks[sizeClass] = reinterpret_cast<Node**>(*res);
+                return res;
+            }
+
+            const std::size_t size = SparseChildren::get_blockSize(sizeClass);
+            if (static_cast<std::size_t>(childEnd - childPos) < size){
+                const std::size_t slabSize = std::max(size, CHILD_SLAB_SIZE);
+                childSlabs.reserve(childSlabs.size() + 1);
+                Node** const blocks = std::allocator<Node*>().allocate(slabSize);
+                childSlabs.push_back({blocks, slabSize});
+                childPos = blocks;
+                childEnd = blocks + slabSize;
+            }
+            Node** const res = childPos;
+            childPos += size;
+            return res;
+        }
+
+        void free_Children(Node** block, uint_fast8_t sizeClass) noexcept {
+            *block = reinterpret_cast<Node*>(freeBlocks[sizeClass]);
+            freeBlocks[sizeClass] = block;
+        }
+
+        void release() noexcept {
+            for (const auto& e : slabs){
+                std::allocator<Node>().deallocate(e.nodes, e.cnt);
+            }
+            for (const auto& e : childSlabs){
+                std::allocator<Node*>().deallocate(e.nodes, e.cnt);
+            }
+            slabs.clear();
+            childSlabs.clear();
+            slabPos = slabEnd = nullptr;
+            childPos = childEnd = nullptr;
+            std::fill(std::begin(freeBlocks), std::end(freeBlocks), nullptr);
+            freeNodes = nullptr;
+            freeNodeCnt = 0;
+            nextSlabSize = MIN_SLAB_SIZE;
+            nodeCnt = 0;
+        }
+
+        std::vector<Slab<Node>> slabs{};
+        Node* slabPos{nullptr};
+        Node* slabEnd{nullptr};
+        std::size_t nextSlabSize{MIN_SLAB_SIZE};
+        std::size_t nodeCnt{0};
+
+        std::vector<Slab<Node*>> childSlabs{};
+        Node** childPos{nullptr};
+        Node** childEnd{nullptr};
+        Node** freeBlocks[PROPERTIES_CNT + 1]{};
+        Node* freeNodes{nullptr};
+        std::size_t freeNodeCnt{0};
+    };
+
     Node* root;
+    NodeArena arena{};
+    double rebalanceAlpha{0};
+    double rebalanceLogBase{0};
 
 
 // ** Helper Functions **
 
     /*
     Example:
-        compArr[0](left, right) return left[0] < right[0] 
-        compArr[1](left, right) return left[1] < right[1] 
+        ComparisonT compares left[0] > right[0] for bit 0
+        and left[1] > right[1] for bit 1
         
         struct XY{int x,y};
         left        right       out(binary) out(decimal)    meaning
@@ -358,26 +1263,781 @@ private:
         if (out <= PROPERTIES_CNT/2) then left is "smaller" than right
 
     */
-    inline static BUCKET_TYPE get_ComparisonIndex(const ElementT& left, const ElementT& right) noexcept {
-        BUCKET_TYPE childPos = 0;
-        for(uint_fast8_t cnt = 0; cnt != PROPERTIES_CNT; ++cnt){
-            childPos += (compArr[cnt](left, right) == true) ? (1 << cnt):(0);
+    inline static BUCKET_TYPE get_ComparisonIndex(const KeyT& left, const KeyT& right) noexcept {
+        return static_cast<BUCKET_TYPE>(ComparisonT::get_Index(left, right));
+    }
+
+    /*
+    the first child of node, or else the next sibling of node or of one of its parents below top.
+    returns nullptr after the last node below top.
+    */
+    static Node* get_nextNode(Node* node, const Node* top) noexcept {
+        for (BUCKET_TYPE pos = 0, end = node->get_childEnd(); pos != end; ++pos){
+            if (Node* const child = node->get_childAt(pos)){
+                return child;
+            }
+        }
+
+        for (; node != top; node = node->parent){ // node is the last node of its branch, look for the next sibling upwards
+            const Node* const parent = node->parent;
+            for (BUCKET_TYPE pos = parent->get_positionOf(node) + 1, end = parent->get_childEnd(); pos != end; ++pos){
+                if (Node* const child = parent->get_childAt(pos)){
+                    return child;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    inline static bool is_inRange(const KeyT& obj, const KeyT& lhs, const KeyT& rhs) noexcept {
+        return (ComparisonT::get_Index(lhs, obj) | ComparisonT::get_Index(obj, rhs)) == 0;
+    }
+
+    /*
+    a bucket of node can hold elements of the box from lhs to rhs, if
+        its bit of a property is set only where node is bigger than lhs, as the elements of a set bit are smaller than node,
+        and its bit is set everywhere node is bigger than rhs, as the elements of an unset bit are not smaller than node.
+    so: get_ComparisonIndex(node, rhs) is a subset of bucket, which is a subset of get_ComparisonIndex(node, lhs).
+    */
+    inline static bool is_rangeBucket(BUCKET_TYPE bucket, BUCKET_TYPE lowMask, BUCKET_TYPE highMask) noexcept {
+        return (bucket & highMask) == highMask && (bucket & ~lowMask) == 0;
+    }
+
+    /*
+    like get_nextNode(), but skips the buckets, that cannot hold elements of the box from lhs to rhs.
+    */
+    static Node* get_nextRangeNode(Node* node, const Node* top, const KeyT& lhs, const KeyT& rhs) noexcept {
+        BUCKET_TYPE lowMask = get_ComparisonIndex(node->get_Key(), lhs);
+        BUCKET_TYPE highMask = get_ComparisonIndex(node->get_Key(), rhs);
+        for (BUCKET_TYPE pos = 0, end = node->get_childEnd(); pos != end; ++pos){
+            Node* const child = node->get_childAt(pos);
+            if (child && is_rangeBucket(node->get_bucketAt(pos), lowMask, highMask)){
+                return child;
+            }
+        }
+
+        for (; node != top; node = node->parent){
+            const Node* const parent = node->parent;
+            lowMask = get_ComparisonIndex(parent->get_Key(), lhs);
+            highMask = get_ComparisonIndex(parent->get_Key(), rhs);
+            for (BUCKET_TYPE pos = parent->get_positionOf(node) + 1, end = parent->get_childEnd(); pos != end; ++pos){
+                Node* const child = parent->get_childAt(pos);
+                if (child && is_rangeBucket(parent->get_bucketAt(pos), lowMask, highMask)){
+                    return child;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+    sorts items from first to last stably by their buckets, and buckets along with them. scratch has as many pairs as items.
+    a counting sort for few buckets, otherwise a stable_sort, so that neither the time nor the stack grows with BUCKET_CNT.
+    */
+    template<typename ItemT>
+    static void sort_ByBucket(std::vector<ItemT>& items, std::vector<BUCKET_TYPE>& buckets, std::vector<std::pair<ItemT, BUCKET_TYPE>>& scratch, std::size_t first, std::size_t last) {
+        if constexpr (BUCKET_CNT <= 256){
+            std::size_t bucketBegin[BUCKET_CNT] = {};
+            for (std::size_t pos = first; pos != last; ++pos){
+                ++bucketBegin[buckets[pos]];
+            }
+            for (std::size_t bucket = 0, begin = first; bucket != BUCKET_CNT; ++bucket){ // counting sort by bucket
+                begin += std::exchange(bucketBegin[bucket], begin);
+            }
+            for (std::size_t pos = first; pos != last; ++pos){
+                scratch[bucketBegin[buckets[pos]]++] = {items[pos], buckets[pos]};
+            }
+        } else {
+            for (std::size_t pos = first; pos != last; ++pos){
+                scratch[pos] = {items[pos], buckets[pos]};
+            }
+            std::stable_sort(scratch.begin() + first, scratch.begin() + last, [](const auto& lhs, const auto& rhs){ return lhs.second < rhs.second; });
+        }
+        for (std::size_t pos = first; pos != last; ++pos){
+            items[pos] = scratch[pos].first;
+            buckets[pos] = scratch[pos].second;
         }
-        return childPos;
     }
 
-    static Node& internal_push(ElementT& obj, Node** node) noexcept {
-        for (Node* n = *node; n != nullptr; n = *node){
-            const BUCKET_TYPE childPos = get_ComparisonIndex(***node, obj);
-            node = &(**node).children[childPos];
+    /*
+    builds the tree of make_Balanced() from an array of pointers to the elements.
+    the node of the element at position i of the array is at position i of one block of nodes, 
+    so that subtrees, that are built in parallel, do not share anything but their disjoint parts of both arrays.
+    a rebuilt subtree uses its old nodes, one for each element, instead of a new block.
+    */
+    class BalancedBuild{
+    public:
+
+        template<typename IteratorType>
+        BalancedBuild(Basic_K_Tree& arg_tree, IteratorType arr, std::size_t cnt, ThreadPool* arg_pool):
+            tree(arg_tree),
+            pool(arg_pool)
+        {
+            elements.reserve(cnt);
+            while (cnt-- != 0){
+                ElementT& e = *arr;
+                elements.push_back(&e);
+                ++arr;
+            }
+            scratch.resize(elements.size());
+            buckets.resize(elements.size());
+        }
+
+        BalancedBuild(Basic_K_Tree& arg_tree, std::vector<ElementT*>&& arg_elements, std::vector<Node*>&& arg_recycled):
+            tree(arg_tree),
+            pool(nullptr),
+            elements(std::move(arg_elements)),
+            recycled(std::move(arg_recycled))
+        {
+            scratch.resize(elements.size());
+            buckets.resize(elements.size());
+        }
+
+        /*
+        returns the root of the built tree, whose parent is parent.
+        */
+        Node* run(Node* parent) {
+            if (elements.empty()){
+                return nullptr;
+            }
+            if (recycled.empty()){
+                nodes = tree.arena.allocate_Block(elements.size());
+            }
+            return build(0, elements.size(), parent, 0);
+        }
+
+    private:
+
+        /*
+        builds the subtree of the elements from first to last and returns its root.
+        */
+        Node* build(std::size_t first, std::size_t last, Node* parent, uint_fast8_t property) {
+            ElementT** const arr = elements.data();
+            ElementT** const mid = arr + first + (last - first)/2;
+            std::nth_element(arr + first, mid, arr + last, [property](const ElementT* lhs, const ElementT* rhs){
+                return ComparisonT::is_bigger(property, get_Key(*rhs), get_Key(*lhs));
+            });
+            std::swap(arr[first], *mid);
+
+            Node* const node = ::new (static_cast<void*>(recycled.empty()? nodes + first : recycled[first])) Node(arr[first], parent);
+            const KeyT& pivot = node->get_Key();
+
+            for (std::size_t pos = first + 1; pos != last; ++pos){
+                buckets[pos] = get_ComparisonIndex(pivot, get_Key(*arr[pos]));
+            }
+            sort_ByBucket(elements, buckets, scratch, first + 1, last);
+
+            { // the children are added before they are built, so that the subtrees only write to their own slots
+                std::unique_lock lock(childGuard, std::defer_lock);
+                if (pool){
+                    lock.lock();
+                }
+                for (std::size_t begin = first + 1; begin != last; begin = get_bucketEnd(begin, last)){
+                    tree.add_Child(*node, buckets[begin], nullptr);
+                }
+            }
+
+            // the end of a bucket is found before its subtree is built, because the build reuses buckets inside of it
+            const uint_fast8_t nextProperty = (property + 1 == PROPERTIES_CNT)? 0 : property + 1;
+            BUCKET_TYPE pos = 0;
+            if (pool && last - first > PARALLEL_BUILD_GRAIN){
+                ThreadPool::TaskGroup group(*pool);
+                for (std::size_t begin = first + 1, end; begin != last; begin = end){
+                    end = get_bucketEnd(begin, last);
+                    Node** const slot = get_childSlot(*node, buckets[begin], pos++);
+                    group.run([this, node, slot, begin, end, nextProperty](){
+                        *slot = build(begin, end, node, nextProperty);
+                    });
+                }
+                group.wait();
+            } else {
+                for (std::size_t begin = first + 1, end; begin != last; begin = end){
+                    end = get_bucketEnd(begin, last);
+                    *get_childSlot(*node, buckets[begin], pos++) = build(begin, end, node, nextProperty);
+                }
+            }
+            return node;
+        }
+
+        /*
+        the end of the bucket, that starts at begin, in the sorted buckets.
+        */
+        std::size_t get_bucketEnd(std::size_t begin, std::size_t last) const noexcept {
+            std::size_t end = begin + 1;
+            while (end != last && buckets[end] == buckets[begin]){
+                ++end;
+            }
+            return end;
+        }
+
+        /*
+        where the child in bucket is stored. pos is its position among the children of node.
+        */
+        static Node** get_childSlot(Node& node, BUCKET_TYPE bucket, BUCKET_TYPE pos) noexcept {
+            if constexpr (CHILDREN == K_TreeChildren::dense){
+                return &node.children[bucket];
+            } else {
+                return &node.packed[pos];
+            }
+        }
+
+        Basic_K_Tree& tree;
+        ThreadPool* pool;
+        std::mutex childGuard{};
+        Node* nodes{nullptr};
+        std::vector<ElementT*> elements{};
+        std::vector<Node*> recycled{};
+        std::vector<std::pair<ElementT*, BUCKET_TYPE>> scratch{};
+        std::vector<BUCKET_TYPE> buckets{};
+    };
+
+    static void prefetch_Node(const Node* node) noexcept {
+#if defined(__SSE2__)
+        _mm_prefetch(reinterpret_cast<const char*>(node), _MM_HINT_T0);
+#elif defined(__GNUC__)
+        __builtin_prefetch(node);
+#endif
+    }
+
+    /*
+    routes a block of elements through the tree, see push_batch() and find_batch().
+    a frame is a part of the block, that descends below one node. a part of one element becomes a lane, 
+    and the lanes descend in step, so that their paths are disjoint and the order of the pushes does not matter.
+    */
+    template<bool IS_PUSHING>
+    class BatchRoute{
+    public:
+        using ElementPtrT = std::conditional_t<IS_PUSHING, ElementT*, const ElementT*>;
+
+        BatchRoute(Basic_K_Tree& arg_tree):
+            tree(arg_tree)
+        {
+
+        }
+
+        void add(std::conditional_t<IS_PUSHING, ElementT&, const ElementT&> obj) {
+            items.push_back({elements.size(), hold_Key(obj)});
+            elements.push_back(&obj);
+        }
+
+        void run() {
+            found.assign(IS_PUSHING? 0 : items.size(), nullptr);
+            if (items.empty()){
+                return;
+            }
+            std::size_t first = 0;
+            if constexpr (IS_PUSHING){
+                if (tree.root == nullptr){
+                    tree.root = tree.arena.allocate(elements[0], nullptr);
+                    first = 1;
+                }
+            }
+            if (tree.root == nullptr){
+                return;
+            }
+
+            buckets.resize(items.size());
+            sorted.resize(items.size());
+            frames.push_back({tree.root, first, items.size()});
+            while (!frames.empty()){
+                const Frame frame = frames.back();
+                frames.pop_back();
+                if (frame.last - frame.first == 1){
+                    lanes.push_back({frame.node, items[frame.first]});
+                    if (lanes.size() == BATCH_LANES){
+                        descend_Lanes();
+                    }
+                } else if (frame.last != frame.first){
+                    split(frame);
+                }
+            }
+            descend_Lanes();
+        }
+
+        std::vector<Node*> take_Found() noexcept {
+            return std::move(found);
+        }
+
+    private:
+
+        struct Item{
+            std::size_t pos;
+            KeyHolder key;
+        };
+
+        struct Frame{
+            Node* node;
+            std::size_t first;
+            std::size_t last;
+        };
+
+        struct Lane{
+            Node* node;
+            Item item;
+        };
+
+        /*
+        sorts the items of frame by their bucket at its node, stably, and hands each bucket on to its child.
+        */
+        void split(const Frame& frame) {
+            Node& node = *frame.node;
+            const KeyT& nodeKey = node.get_Key();
+            std::size_t last = frame.first;
+            for (std::size_t pos = frame.first; pos != frame.last; ++pos){
+                const Item item = items[pos];
+                const BUCKET_TYPE bucket = get_ComparisonIndex(nodeKey, get_HeldKey(item.key));
+                if constexpr (!IS_PUSHING){
+                    if (bucket == 0 && get_ComparisonIndex(get_HeldKey(item.key), nodeKey) == 0){
+                        found[item.pos] = &node;
+                        continue;
+                    }
+                }
+                items[last] = item;
+                buckets[last] = bucket;
+                ++last;
+            }
+            sort_ByBucket(items, buckets, sorted, frame.first, last);
+
+            for (std::size_t first = frame.first, end; first != last; first = end){
+                const BUCKET_TYPE bucket = buckets[first];
+                for (end = first + 1; end != last && buckets[end] == bucket; ++end){
+
+                }
+                Node* child = node.get_child(bucket);
+                if (child){
+                    prefetch_Node(child);
+                    frames.push_back({child, first, end});
+                } else if constexpr (IS_PUSHING){
+                    child = tree.arena.allocate(elements[items[first].pos], &node);
+                    tree.add_Child(node, bucket, child);
+                    frames.push_back({child, first + 1, end});
+                }
+            }
+        }
+
+        /*
+        moves every lane one node down per round, until each found its node or its empty slot.
+        */
+        void descend_Lanes() {
+            while (!lanes.empty()){
+                for (std::size_t pos = 0; pos < lanes.size(); ){
+                    Lane& lane = lanes[pos];
+                    const KeyT& key = get_HeldKey(lane.item.key);
+                    const BUCKET_TYPE bucket = get_ComparisonIndex(lane.node->get_Key(), key);
+                    if constexpr (!IS_PUSHING){
+                        if (bucket == 0 && get_ComparisonIndex(key, lane.node->get_Key()) == 0){
+                            found[lane.item.pos] = lane.node;
+                            lane = lanes.back();
+                            lanes.pop_back();
+                            continue;
+                        }
+                    }
+                    Node* const child = lane.node->get_child(bucket);
+                    if (child){
+                        prefetch_Node(child);
+                        lane.node = child;
+                        ++pos;
+                        continue;
+                    }
+                    if constexpr (IS_PUSHING){
+                        tree.add_Child(*lane.node, bucket, tree.arena.allocate(elements[lane.item.pos], lane.node));
+                    }
+                    lane = lanes.back();
+                    lanes.pop_back();
+                }
+            }
+        }
+
+        Basic_K_Tree& tree;
+        std::vector<ElementPtrT> elements{};
+        std::vector<Item> items{};
+        std::vector<BUCKET_TYPE> buckets{};
+        std::vector<std::pair<Item, BUCKET_TYPE>> sorted{};
+        std::vector<Frame> frames{};
+        std::vector<Lane> lanes{};
+        std::vector<Node*> found{};
+    };
+
+    /*
+    the walk of for_range_batch(). the boxes, that reach a node, are a segment of active, 
+    and the segments of its children are appended behind it. a frame is only taken from the stack after the frames above it, 
+    so everything behind its segment belongs to finished frames and is dropped.
+    */
+    template<typename IteratorType, typename FuncT>
+    static void walk_RangeBatch(Node* top, IteratorType lows, IteratorType highs, std::size_t cnt, FuncT&& func) {
+        if (top == nullptr || cnt == 0){
+            return;
+        }
+        std::vector<std::pair<KeyHolder, KeyHolder>> boxes;
+        boxes.reserve(cnt);
+        std::vector<std::size_t> active;
+        for (std::size_t pos = 0; pos != cnt; ++pos, ++lows, ++highs){
+            boxes.emplace_back(hold_Key(*lows), hold_Key(*highs));
+            active.push_back(pos);
+        }
+
+        struct Frame{
+            Node* node;
+            std::size_t first;
+            std::size_t last;
+        };
+        std::vector<Frame> frames{{top, 0, cnt}};
+        std::vector<std::pair<BUCKET_TYPE, BUCKET_TYPE>> masks;
+        while (!frames.empty()){
+            const Frame frame = frames.back();
+            frames.pop_back();
+            active.resize(frame.last);
+
+            Node& node = *frame.node;
+            const KeyT& nodeKey = node.get_Key();
+            masks.clear();
+            for (std::size_t pos = frame.first; pos != frame.last; ++pos){
+                const KeyT& low = get_HeldKey(boxes[active[pos]].first);
+                const KeyT& high = get_HeldKey(boxes[active[pos]].second);
+                masks.emplace_back(get_ComparisonIndex(nodeKey, low), get_ComparisonIndex(nodeKey, high));
+                if (is_inRange(nodeKey, low, high)){
+                    func(active[pos], *node);
+                }
+            }
+
+            for (BUCKET_TYPE pos = 0, end = node.get_childEnd(); pos != end; ++pos){
+                Node* const child = node.get_childAt(pos);
+                if (!child){
+                    continue;
+                }
+                const BUCKET_TYPE bucket = node.get_bucketAt(pos);
+                const std::size_t first = active.size();
+                for (std::size_t box = frame.first; box != frame.last; ++box){
+                    if (is_rangeBucket(bucket, masks[box - frame.first].first, masks[box - frame.first].second)){
+                        active.push_back(active[box]);
+                    }
+                }
+                if (active.size() != first){
+                    prefetch_Node(child);
+                    frames.push_back({child, first, active.size()});
+                }
+            }
+        }
+    }
+
+    /*
+    the state of one nearest() search. the heap and the stack keep their memory between searches.
+    */
+    template<typename DistanceFuncT, typename BoundFuncT>
+    class NearestSearch{
+    public:
+        using DistanceT = std::decay_t<std::invoke_result_t<DistanceFuncT&, const ElementT&, const ElementT&>>;
+        using NeighbourT = Neighbour<DistanceT>;
+
+        NearestSearch(std::size_t arg_k, DistanceFuncT& arg_distance, BoundFuncT& arg_bound):
+            k(arg_k),
+            distance(arg_distance),
+            bound(arg_bound)
+        {
+
+        }
+
+        /*
+        depth first, the bucket of query before its siblings, so that close nodes are found early and prune the rest.
+        every node on the stack carries the biggest bound of its ancestors, which is a lower bound of the distance of its whole subtree.
+        */
+        void run(Node* root, const ElementT& query) {
+            heap.clear();
+            if (!root || k == 0){
+                return;
+            }
+            stack.clear();
+            stack.push_back({root, DistanceT{}});
+            const KeyT& queryKey = get_Key(query);
+
+            while (!stack.empty()){
+                const NeighbourT top = stack.back();
+                stack.pop_back();
+                if (is_pruned(top.distance)){
+                    continue;
+                }
+
+                const ElementT& element = **top.node;
+                insert(top.node, distance(query, element));
+
+                const BUCKET_TYPE queryBucket = get_ComparisonIndex(top.node->get_Key(), queryKey);
+                DistanceT axisBounds[PROPERTIES_CNT];
+                bool hasAxisBound[PROPERTIES_CNT] = {};
+                for (BUCKET_TYPE pos = top.node->get_childEnd(); pos-- != 0; ){
+                    Node* const child = top.node->get_childAt(pos);
+                    const BUCKET_TYPE bucket = top.node->get_bucketAt(pos);
+                    if (!child || bucket == queryBucket){
+                        continue;
+                    }
+                    DistanceT childBound = top.distance;
+                    for (uint_fast8_t property = 0; property != PROPERTIES_CNT; ++property){
+                        if (((bucket ^ queryBucket) >> property) & 1){
+                            if (!hasAxisBound[property]){
+                                axisBounds[property] = bound(property, query, element);
+                                hasAxisBound[property] = true;
+                            }
+                            if (childBound < axisBounds[property]){
+                                childBound = axisBounds[property];
+                            }
+                        }
+                    }
+                    if (!is_pruned(childBound)){
+                        stack.push_back({child, childBound});
+                    }
+                }
+                if (Node* const child = top.node->get_child(queryBucket)){
+                    stack.push_back({child, top.distance});
+                }
+            }
+        }
+
+        std::vector<NeighbourT> take_Result() {
+            std::sort_heap(heap.begin(), heap.end(), is_closer);
+            std::vector<NeighbourT> res(heap.begin(), heap.end());
+            heap.clear();
+            return res;
+        }
+
+    private:
+
+        static bool is_closer(const NeighbourT& lhs, const NeighbourT& rhs) noexcept {
+            return lhs.distance < rhs.distance;
+        }
+
+        bool is_pruned(const DistanceT& lowerBound) const noexcept {
+            return heap.size() == k && !(lowerBound < heap.front().distance);
+        }
+
+        void insert(Node* node, DistanceT dist) {
+            if (heap.size() != k){
+                heap.push_back({node, dist});
+                std::push_heap(heap.begin(), heap.end(), is_closer);
+            } else if (dist < heap.front().distance){
+                std::pop_heap(heap.begin(), heap.end(), is_closer);
+                heap.back() = {node, dist};
+                std::push_heap(heap.begin(), heap.end(), is_closer);
+            }
+        }
+
+        std::size_t k;
+        DistanceFuncT& distance;
+        BoundFuncT& bound;
+        std::vector<NeighbourT> heap{};
+        std::vector<NeighbourT> stack{};
+    };
+
+    /*
+    the buckets on the way from the root towards obj, as many as fit into 64 bits, the first one in the highest bits.
+    close elements share the beginning of their path and get close keys.
+    */
+    uint_fast64_t get_pathKey(const ElementT& obj) const noexcept {
+        const KeyT& objKey = get_Key(obj);
+        uint_fast64_t key = 0;
+        uint_fast8_t bitCnt = 0;
+        for (const Node* node = root; node != nullptr && bitCnt + PROPERTIES_CNT <= 64; bitCnt += PROPERTIES_CNT){
+            const BUCKET_TYPE bucket = get_ComparisonIndex(node->get_Key(), objKey);
+            key |= static_cast<uint_fast64_t>(bucket) << (64 - PROPERTIES_CNT - bitCnt);
+            node = node->get_child(bucket);
+        }
+        return key;
+    }
+
+    Node& internal_push(ElementT& obj) noexcept {
+        const KeyT& key = get_Key(obj);
+        Node* parent = nullptr;
+        BUCKET_TYPE childPos = 0;
+        std::size_t depth = 1;
+        for (Node* n = root; n != nullptr; n = n->get_child(childPos), ++depth){
+            childPos = get_ComparisonIndex(n->get_Key(), key);
+            parent = n;
         }
         
-        return *(*node = new Node(&obj));
+        Node* const node = arena.allocate(&obj, parent);
+        if (parent){
+            add_Child(*parent, childPos, node);
+        } else {
+            root = node;
+        }
+
+        if (rebalanceAlpha != 0 && static_cast<double>(depth) > std::log(static_cast<double>(arena.nodeCnt))/rebalanceLogBase + 1){
+            if (rebalance_From(*node)){
+                return *find_Node(obj);
+            }
+        }
+        return *node;
+    }
+
+    /*
+    walks up from node and rebuilds the subtree of the first ancestor, that has a child with more than alpha times its nodes.
+    counting the nodes of the siblings on the way costs about as much as the rebuild, so both are amortized by the pushes, that made the subtree deep.
+    returns false, if there was no such ancestor.
+    */
+    bool rebalance_From(Node& node) {
+        std::size_t size = 1;
+        for (Node* child = &node, * parent = node.parent; parent != nullptr; child = parent, parent = parent->parent){
+            std::size_t parentSize = 1;
+            for (BUCKET_TYPE pos = 0, end = parent->get_childEnd(); pos != end; ++pos){
+                Node* const sibling = parent->get_childAt(pos);
+                if (sibling){
+                    parentSize += (sibling == child)? size : get_subtreeSize(sibling);
+                }
+            }
+            if (static_cast<double>(size) > rebalanceAlpha * static_cast<double>(parentSize)){
+                rebuild_Subtree(*parent, nullptr);
+                return true;
+            }
+            size = parentSize;
+        }
+        return false;
+    }
+
+    static bool has_Children(const Node& node) noexcept {
+        for (BUCKET_TYPE pos = 0, end = node.get_childEnd(); pos != end; ++pos){
+            if (node.get_childAt(pos)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static std::size_t get_subtreeSize(Node* top) noexcept {
+        std::size_t res = 0;
+        for (Node* node = top; node != nullptr; node = get_nextNode(node, top)){
+            ++res;
+        }
+        return res;
+    }
+
+    /*
+    rebuilds the subtree of top balanced, on the same nodes, without the element of skip.
+    the node of skip is freed, if it is in the subtree.
+    */
+    void rebuild_Subtree(Node& top, const Node* skip) {
+        Node* const parent = top.parent; // top is overwritten by the build
+        const BUCKET_TYPE pos = parent? parent->get_positionOf(&top) : 0;
+
+        std::vector<ElementT*> elements;
+        std::vector<Node*> nodes;
+        for (Node* node = &top; node != nullptr; node = get_nextNode(node, &top)){
+            if (node != skip){
+                elements.push_back(node->value);
+            }
+            nodes.push_back(node);
+        }
+        for (Node* const node : nodes){
+            release_Children(*node);
+        }
+        if (skip){
+            arena.free_Node(nodes.back());
+            nodes.pop_back();
+        }
+
+        Node* const res = BalancedBuild(*this, std::move(elements), std::move(nodes)).run(parent);
+        if (parent){
+            set_ChildAt(*parent, pos, res);
+        } else {
+            root = res;
+        }
+    }
+
+    /*
+    puts child at the place of node in its parent. removes that place, if child is nullptr.
+    */
+    void replace_Child(const Node& node, Node* child) {
+        if (Node* const parent = node.parent){
+            set_ChildAt(*parent, parent->get_positionOf(&node), child);
+        } else {
+            root = child;
+        }
+    }
+
+    void set_ChildAt(Node& node, BUCKET_TYPE pos, Node* child) {
+        if constexpr (CHILDREN == K_TreeChildren::dense){
+            node.children[pos] = child;
+        } else if (child){
+            node.packed[pos] = child;
+        } else {
+            BUCKET_TYPE* const buckets = SparseChildren::get_blockBuckets(node.packed, node.sizeClass);
+            if constexpr (SparseChildren::HAS_MASK){
+                node.mask &= ~(uint_fast64_t(1) << buckets[pos]);
+            }
+            std::copy(node.packed + pos + 1, node.packed + node.childCnt, node.packed + pos);
+            std::copy(buckets + pos + 1, buckets + node.childCnt, buckets + pos);
+            if (--node.childCnt == 0){
+                release_Children(node);
+            }
+        }
+    }
+
+    /*
+    gives the block of the sparse children of node back to the arena.
+    */
+    void release_Children(Node& node) noexcept {
+        if constexpr (CHILDREN == K_TreeChildren::sparse){
+            if (node.packed){
+                arena.free_Children(node.packed, node.sizeClass);
+                node.packed = nullptr;
+                node.childCnt = 0;
+                node.sizeClass = 0;
+                node.mask = {};
+            }
+        }
+    }
+
+    /*
+    UB if node already has a child in bucket.
+    a sparse node moves its children into a block twice as big, if its block is full.
+    */
+    void add_Child(Node& node, BUCKET_TYPE bucket, Node* child) {
+        if constexpr (CHILDREN == K_TreeChildren::dense){
+            node.children[bucket] = child;
+        } else {
+            const BUCKET_TYPE pos = node.get_bucketPosition(bucket);
+            BUCKET_TYPE* buckets = node.packed? SparseChildren::get_blockBuckets(node.packed, node.sizeClass) : nullptr;
+
+            if (!node.packed || node.childCnt == (std::size_t(1) << node.sizeClass)){
+                const uint_fast8_t sizeClass = node.packed? node.sizeClass + 1 : 0;
+                Node** const block = arena.allocate_Children(sizeClass);
+                BUCKET_TYPE* const blockBuckets = SparseChildren::get_blockBuckets(block, sizeClass);
+                if (node.packed){
+                    std::copy(node.packed, node.packed + pos, block);
+                    std::copy(node.packed + pos, node.packed + node.childCnt, block + pos + 1);
+                    std::copy(buckets, buckets + pos, blockBuckets);
+                    std::copy(buckets + pos, buckets + node.childCnt, blockBuckets + pos + 1);
+                    arena.free_Children(node.packed, node.sizeClass);
+                }
+                node.packed = block;
+                node.sizeClass = sizeClass;
+                buckets = blockBuckets;
+            } else {
+                std::copy_backward(node.packed + pos, node.packed + node.childCnt, node.packed + node.childCnt + 1);
+                std::copy_backward(buckets + pos, buckets + node.childCnt, buckets + node.childCnt + 1);
+            }
+
+            node.packed[pos] = child;
+            buckets[pos] = bucket;
+            ++node.childCnt;
+            if constexpr (SparseChildren::HAS_MASK){
+                node.mask |= uint_fast64_t(1) << bucket;
+            }
+        }
     }
 
 
 };
 
+/*
+    see Basic_K_Tree. compares with the array compArr of PROPERTIES_CNT function pointers.
+    its nodes are dense, unless CHILDREN says otherwise, as they were before sparse nodes existed.
+*/
+template<
+	typename ElementT, 
+	uint_fast8_t PROPERTIES_CNT, 
+	bool (* const (&compArr)[PROPERTIES_CNT]) (const ElementT&, const ElementT&),
+	K_TreeChildren CHILDREN = K_TreeChildren::dense
+>
+using K_Tree = Basic_K_Tree<ElementT, K_TreeFunctionArray<ElementT, PROPERTIES_CNT, compArr>, CHILDREN>;
+
 }
 #endif
 
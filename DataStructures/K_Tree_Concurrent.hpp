@@ -0,0 +1,590 @@
+#ifndef K_TREE_CONCURRENT_HPP
+#define K_TREE_CONCURRENT_HPP
+
+/*
+
+-- Part of KozyLibrary/DataStructures
+
+*/
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "K_Tree.hpp"
+
+
+namespace KozyLibrary {
+
+/*
+* DESCRIPTION *
+
+A K_Tree, that many threads push into, remove from and read at the same time, without a lock.
+The tree does not take ownership of the elements.
+
+push() descends like Basic_K_Tree::push() and publishes the new node with one compare and swap of the empty child slot,
+that it found. If another push won that slot, it descends further into the winner. No push waits for another one.
+Readers only load child pointers, so they never wait and never retry.
+
+remove_element() takes the element out of its node with a compare and swap, the node itself stays in the tree and keeps routing.
+A removed node without children is unlinked from its parent, and a removed parent, that lost its last child, is unlinked after it.
+An unlinked node is retired: it is reused by a later push, once no thread can see it anymore.
+That is decided by epochs: every operation pins the current epoch for as long as it holds pointers to nodes,
+and a node retired in epoch e is reused after the epoch reached e + 2, which needs every pinned thread to have seen e + 1.
+
+pin() returns a Guard, that the overloads taking a Guard use, so that a thread, that does many operations in a row, pins only once.
+The other overloads pin for the time of their call.
+
+Assumptions:
+- the tree is not destroyed, while an operation runs or a Guard is held.
+- an element is not deleted whilst a node points to it, or a reader, that started before its remove_element() returned, may still visit it.
+- a Guard is used by one thread at a time.
+- at most PIN_SLOTS Guards are held at once. pin() yields until one is released otherwise.
+
+
+* TEMPLATE PARAMETERS *
+
+ElementT			: The underlying Element Type.
+
+ComparisonT			: see Basic_K_Tree.
+
+KeyExtractorT		: see Basic_K_Tree. The nodes always cache the keys, so that a removed element is not read to route a push.
+
+
+* OTHER *
+
+The nodes are dense, see K_TreeChildren, with an atomic pointer per bucket.
+
+Each pinned Guard takes nodes for its pushes ALLOCATION_CHUNK at a time from shared slabs, and counts its own pushes and removals,
+so that pushes on different threads do not share a cache line until they meet in the tree.
+The slabs grow geometrically and are only released by the destructor.
+
+*/
+template<
+	typename ElementT,
+	typename ComparisonT,
+	typename KeyExtractorT = K_TreeCopyKey
+>
+requires (!std::is_void_v<KeyExtractorT> && K_TreeComparison<ComparisonT, typename K_TreeKey<ElementT, KeyExtractorT>::type>)
+class Concurrent_K_Tree {
+public:
+
+	inline static constexpr uint_fast8_t PROPERTIES_CNT			= ComparisonT::PROPERTIES_CNT;
+	inline static constexpr std::size_t BUCKET_CNT				= std::size_t{1} << PROPERTIES_CNT;
+	inline static constexpr std::size_t PIN_SLOTS				= 64;
+	inline static constexpr std::size_t ALLOCATION_CHUNK		= 64;
+	inline static constexpr std::size_t RECLAIM_INTERVAL		= 64;
+
+	static_assert(PROPERTIES_CNT <= 8, "dense nodes with more than 256 atomic children are too big");
+
+	using BUCKET_TYPE = uint_fast16_t;
+	using KeyT = typename K_TreeKey<ElementT, KeyExtractorT>::type;
+
+	static KeyT get_Key(const ElementT& obj) noexcept(K_TreeKey<ElementT, KeyExtractorT>::IS_NOTHROW) {
+		return KeyT(KeyExtractorT{}(obj));
+	}
+
+private:
+	struct PinSlot;
+
+public:
+
+	/*
+		keeps the epoch pinned, so that no node, that was reachable, is reused while it is held.
+	*/
+	class Guard {
+	public:
+		Guard(Guard&& mv) noexcept:
+			slot(std::exchange(mv.slot, nullptr))
+		{
+
+		}
+
+		Guard(const Guard&) = delete;
+		Guard& operator=(const Guard&) = delete;
+		Guard& operator=(Guard&&) = delete;
+
+		~Guard() {
+			if (slot){
+				slot->epoch.store(0);
+			}
+		}
+
+	private:
+		friend class Concurrent_K_Tree;
+
+		explicit Guard(PinSlot* arg_slot) noexcept:
+			slot(arg_slot)
+		{
+
+		}
+
+		PinSlot* slot;
+	};
+
+
+	Concurrent_K_Tree() = default;
+
+	Concurrent_K_Tree(const Concurrent_K_Tree&) = delete;
+	Concurrent_K_Tree& operator=(const Concurrent_K_Tree&) = delete;
+	Concurrent_K_Tree(Concurrent_K_Tree&&) = delete;
+	Concurrent_K_Tree& operator=(Concurrent_K_Tree&&) = delete;
+
+	~Concurrent_K_Tree() {
+		for (std::size_t slab = 0; slab != MAX_SLABS; ++slab){
+			if (Node* const nodes = slabs[slab].load()){
+				std::allocator<Node>().deallocate(nodes, get_slabSize(slab));
+			}
+		}
+	}
+
+	/*
+		pins the current epoch on a free slot.
+	*/
+	Guard pin() const {
+		thread_local const std::size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+		for (std::size_t pos = hint;; ++pos){
+			PinSlot& slot = pinSlots[pos % PIN_SLOTS];
+			uint_fast64_t free = 0;
+			uint_fast64_t current = globalEpoch.load();
+			if (slot.epoch.compare_exchange_strong(free, current)){
+				for (uint_fast64_t seen = globalEpoch.load(); seen != current; seen = globalEpoch.load()){ // the epoch moved on before it was pinned
+					current = seen;
+					slot.epoch.store(current);
+				}
+				return Guard(&slot);
+			}
+			if (pos % PIN_SLOTS == (hint + PIN_SLOTS - 1) % PIN_SLOTS){
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void push(ElementT& obj) {
+		Guard guard = pin();
+		push(obj, guard);
+	}
+
+	/*
+		UB if guard was not pinned on this tree.
+	*/
+	void push(ElementT& obj, Guard& guard) {
+		PinSlot& pinSlot = *guard.slot;
+		Node* const node = allocate_Node(obj, pinSlot);
+		const KeyT& key = node->key;
+
+		std::atomic<Node*>* link = &root;
+		Node* parent = nullptr;
+		BUCKET_TYPE bucket = 0;
+		for (;;){
+			Node* current = link->load(std::memory_order_acquire);
+			if (current == nullptr){
+				if (parent && !reserve_Child(*parent)){ // parent is being unlinked, its slot will disappear
+					unlink(parent, pinSlot);
+					link = &root;
+					parent = nullptr;
+					bucket = 0;
+					continue;
+				}
+				node->parent = parent;
+				node->bucket = bucket;
+				if (link->compare_exchange_strong(current, node, std::memory_order_acq_rel, std::memory_order_acquire)){
+					pinSlot.pushCnt.store(pinSlot.pushCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+					return;
+				}
+				if (parent && parent->state.fetch_sub(1) == 1){ // the winner was unlinked meanwhile
+					try_Unlink(parent, pinSlot);
+				}
+			}
+			bucket = get_ComparisonIndex(current->key, key);
+			parent = current;
+			link = &current->children[bucket];
+		}
+	}
+
+	/*
+		returns an element, whose key is equal to the key of obj, or nullptr.
+	*/
+	ElementT* find(const ElementT& obj) const {
+		Guard guard = pin();
+		return find(obj, guard);
+	}
+
+	ElementT* find(const ElementT& obj, Guard&) const {
+		const KeyT key = get_Key(obj);
+		for (Node* node = root.load(std::memory_order_acquire); node != nullptr; ){
+			const BUCKET_TYPE bucket = get_ComparisonIndex(node->key, key);
+			if (bucket == 0 && get_ComparisonIndex(key, node->key) == 0){
+				if (ElementT* const value = node->value.load(std::memory_order_acquire)){
+					return value;
+				}
+			}
+			node = node->children[bucket].load(std::memory_order_acquire);
+		}
+		return nullptr;
+	}
+
+	/*
+		takes an element, whose key is equal to the key of obj, out of the tree and returns it, or nullptr if there is none.
+	*/
+	ElementT* remove_element(const ElementT& obj) {
+		Guard guard = pin();
+		return remove_element(obj, guard);
+	}
+
+	ElementT* remove_element(const ElementT& obj, Guard& guard) {
+		const KeyT key = get_Key(obj);
+		for (Node* node = root.load(std::memory_order_acquire); node != nullptr; ){
+			const BUCKET_TYPE bucket = get_ComparisonIndex(node->key, key);
+			if (bucket == 0 && get_ComparisonIndex(key, node->key) == 0){
+				ElementT* value = node->value.load(std::memory_order_acquire);
+				if (value && node->value.compare_exchange_strong(value, nullptr)){
+					PinSlot& pinSlot = *guard.slot;
+					pinSlot.removeCnt.store(pinSlot.removeCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+					try_Unlink(node, pinSlot);
+					return value;
+				}
+			}
+			node = node->children[bucket].load(std::memory_order_acquire);
+		}
+		return nullptr;
+	}
+
+	/*
+		calls func(element) for every element, that is in the tree for the whole call.
+		elements pushed or removed meanwhile may or may not be visited.
+	*/
+	template<typename FuncT>
+	void for_each(FuncT&& func) const {
+		Guard guard = pin();
+		Node* const top = root.load(std::memory_order_acquire);
+		for (Node* node = top; node != nullptr; node = get_nextNode(node, top)){
+			if (ElementT* const value = node->value.load(std::memory_order_acquire)){
+				func(*value);
+			}
+		}
+	}
+
+	/*
+		calls func(element) for every element inside of the box from lhs to rhs, see Basic_K_Tree::for_range() and for_each().
+	*/
+	template<typename FuncT>
+	void for_range(const ElementT& lhs, const ElementT& rhs, FuncT&& func) const {
+		Guard guard = pin();
+		const KeyT low = get_Key(lhs);
+		const KeyT high = get_Key(rhs);
+		Node* const top = root.load(std::memory_order_acquire);
+		for (Node* node = top; node != nullptr; node = get_nextRangeNode(node, top, low, high)){
+			if (ElementT* const value = node->value.load(std::memory_order_acquire); value && is_inRange(node->key, low, high)){
+				func(*value);
+			}
+		}
+	}
+
+	std::size_t count_range(const ElementT& lhs, const ElementT& rhs) const {
+		std::size_t cnt = 0;
+		for_range(lhs, rhs, [&cnt](ElementT&){ ++cnt; });
+		return cnt;
+	}
+
+	/*
+		how many elements are in the tree. exact only if no push or removal runs.
+	*/
+	std::size_t get_nodeCnt() const noexcept {
+		std::size_t cnt = 0;
+		for (const PinSlot& slot : pinSlots){
+			cnt += slot.pushCnt.load(std::memory_order_relaxed) - slot.removeCnt.load(std::memory_order_relaxed);
+		}
+		return cnt;
+	}
+
+	bool is_empty() const noexcept {
+		return root.load(std::memory_order_acquire) == nullptr;
+	}
+
+	/*
+		how many nodes were allocated, including the free and the retired ones.
+	*/
+	std::size_t get_capacity() const noexcept {
+		return allocatedCnt.load(std::memory_order_relaxed);
+	}
+
+	/*
+		tries to move on to the next epoch and makes the nodes, that no thread can see anymore, available to push().
+		removals call it every RECLAIM_INTERVAL retired nodes on their own.
+	*/
+	void reclaim() {
+		Guard guard = pin();
+		reclaim_Retired();
+	}
+
+private:
+
+	inline static constexpr uint_fast32_t UNLINKED				= uint_fast32_t{1} << 31;
+	inline static constexpr std::size_t FIRST_SLAB_SIZE			= ALLOCATION_CHUNK * 16;
+	inline static constexpr std::size_t MAX_SLABS				= 40;
+
+	/*
+		a node is constructed once, when its memory is taken from a slab, and reset by every later reuse.
+		next is never written by a reset, because a thread, that lost the race for the head of freeNodes, may still read it.
+	*/
+	struct Node {
+		Node(ElementT* v):
+			value(v),
+			key(get_Key(*v))
+		{
+
+		}
+
+		void reset(ElementT* v) {
+			key = get_Key(*v);
+			parent = nullptr;
+			bucket = 0;
+			state.store(0, std::memory_order_relaxed);
+			for (auto& e : children){
+				e.store(nullptr, std::memory_order_relaxed);
+			}
+			value.store(v, std::memory_order_relaxed);
+		}
+
+		std::atomic<ElementT*> value;           // nullptr once removed
+		Node* parent{nullptr};                  // set before the node is published
+		BUCKET_TYPE bucket{0};                  // in parent
+		std::atomic<uint_fast32_t> state{0};    // count of children and of pushes, that reserved a slot, or UNLINKED
+		KeyT key;
+		std::atomic<Node*> children[BUCKET_CNT]{};
+		std::atomic<Node*> next{nullptr};       // in the retired or the free list
+		uint_fast64_t retireEpoch{0};
+	};
+
+	static_assert(std::is_trivially_destructible_v<KeyT>, "the slabs are released without destroying the nodes");
+
+	/*
+		a pinned epoch, or 0, and the state of the thread, that holds it.
+	*/
+	struct alignas(64) PinSlot {
+		std::atomic<uint_fast64_t> epoch{0};
+		Node* chunkPos{nullptr};
+		Node* chunkEnd{nullptr};
+		std::size_t retiredCnt{0};
+		std::atomic<std::size_t> pushCnt{0};
+		std::atomic<std::size_t> removeCnt{0};
+	};
+
+	inline static BUCKET_TYPE get_ComparisonIndex(const KeyT& left, const KeyT& right) noexcept {
+		return static_cast<BUCKET_TYPE>(ComparisonT::get_Index(left, right));
+	}
+
+	inline static bool is_inRange(const KeyT& obj, const KeyT& lhs, const KeyT& rhs) noexcept {
+		return (ComparisonT::get_Index(lhs, obj) | ComparisonT::get_Index(obj, rhs)) == 0;
+	}
+
+	inline static bool is_rangeBucket(BUCKET_TYPE bucket, BUCKET_TYPE lowMask, BUCKET_TYPE highMask) noexcept {
+		return (bucket & highMask) == highMask && (bucket & ~lowMask) == 0;
+	}
+
+	static std::size_t get_slabSize(std::size_t slab) noexcept {
+		return FIRST_SLAB_SIZE << slab;
+	}
+
+	/*
+		the first child of node, otherwise the next sibling of node or of its closest ancestor below top, that has one.
+		an unlinked node still knows its parent, so a reader, that stands on it, finds its way back.
+	*/
+	static Node* get_nextNode(Node* node, const Node* top) noexcept {
+		for (std::size_t pos = 0; pos != BUCKET_CNT; ++pos){
+			if (Node* const child = node->children[pos].load(std::memory_order_acquire)){
+				return child;
+			}
+		}
+		for (; node != top; node = node->parent){
+			for (std::size_t pos = node->bucket + 1; pos < BUCKET_CNT; ++pos){
+				if (Node* const sibling = node->parent->children[pos].load(std::memory_order_acquire)){
+					return sibling;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	/*
+		like get_nextNode(), but skips the buckets, that cannot hold elements of the box from lhs to rhs.
+	*/
+	static Node* get_nextRangeNode(Node* node, const Node* top, const KeyT& lhs, const KeyT& rhs) noexcept {
+		BUCKET_TYPE lowMask = get_ComparisonIndex(node->key, lhs);
+		BUCKET_TYPE highMask = get_ComparisonIndex(node->key, rhs);
+		for (std::size_t pos = 0; pos != BUCKET_CNT; ++pos){
+			if (is_rangeBucket(static_cast<BUCKET_TYPE>(pos), lowMask, highMask)){
+				if (Node* const child = node->children[pos].load(std::memory_order_acquire)){
+					return child;
+				}
+			}
+		}
+		for (; node != top; node = node->parent){
+			const Node* const parent = node->parent;
+			lowMask = get_ComparisonIndex(parent->key, lhs);
+			highMask = get_ComparisonIndex(parent->key, rhs);
+			for (std::size_t pos = node->bucket + 1; pos < BUCKET_CNT; ++pos){
+				if (is_rangeBucket(static_cast<BUCKET_TYPE>(pos), lowMask, highMask)){
+					if (Node* const sibling = parent->children[pos].load(std::memory_order_acquire)){
+						return sibling;
+					}
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	/*
+		counts a push, that is about to fill a child slot of parent. fails if parent is being unlinked.
+	*/
+	static bool reserve_Child(Node& parent) noexcept {
+		uint_fast32_t state = parent.state.load(std::memory_order_acquire);
+		do {
+			if (state & UNLINKED){
+				return false;
+			}
+		} while (!parent.state.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire));
+		return true;
+	}
+
+	/*
+		unlinks node, if it is removed and has no children, and the ancestors, that become such by that.
+	*/
+	void try_Unlink(Node* node, PinSlot& pinSlot) {
+		uint_fast32_t empty = 0;
+		if (node->value.load() == nullptr && node->state.compare_exchange_strong(empty, UNLINKED)){
+			unlink(node, pinSlot);
+		}
+	}
+
+	/*
+		clears the slot of node, which is UNLINKED, in its parent. any thread may do so, only the one, that succeeds, retires node.
+	*/
+	void unlink(Node* node, PinSlot& pinSlot) {
+		while (node){
+			std::atomic<Node*>& link = node->parent? node->parent->children[node->bucket] : root;
+			Node* expected = node;
+			if (!link.compare_exchange_strong(expected, nullptr)){
+				return;
+			}
+			Node* const parent = node->parent;
+			retire(node, pinSlot);
+
+			// seq_cst, so that either this thread sees the removal of parent, or its remover sees the lost child
+			uint_fast32_t empty = 0;
+			if (parent == nullptr || parent->state.fetch_sub(1) != 1 || parent->value.load() != nullptr
+				|| !parent->state.compare_exchange_strong(empty, UNLINKED)){
+				return;
+			}
+			node = parent;
+		}
+	}
+
+	void retire(Node* node, PinSlot& pinSlot) {
+		node->retireEpoch = globalEpoch.load();
+		push_Stack(retired, node);
+		if (++pinSlot.retiredCnt % RECLAIM_INTERVAL == 0){
+			reclaim_Retired();
+		}
+	}
+
+	/*
+		the calling thread is pinned, so the epoch moves at most one past its own,
+		and no node, that was retired two epochs ago, can still be seen.
+	*/
+	void reclaim_Retired() {
+		uint_fast64_t current = globalEpoch.load();
+		bool isQuiet = true;
+		for (const PinSlot& slot : pinSlots){
+			const uint_fast64_t pinned = slot.epoch.load();
+			isQuiet &= (pinned == 0 || pinned == current);
+		}
+		if (isQuiet && globalEpoch.compare_exchange_strong(current, current + 1)){
+			++current;
+		}
+
+		Node* node = retired.exchange(nullptr, std::memory_order_acquire);
+		while (node){
+			Node* const next = node->next.load(std::memory_order_relaxed);
+			push_Stack((node->retireEpoch + 2 <= current)? freeNodes : retired, node);
+			node = next;
+		}
+	}
+
+	static void push_Stack(std::atomic<Node*>& stack, Node* node) noexcept {
+		Node* head = stack.load(std::memory_order_relaxed);
+		do {
+			node->next.store(head, std::memory_order_relaxed);
+		} while (!stack.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	/*
+		a popped node cannot come back to freeNodes, while the popping thread is pinned, so the head does not suffer from ABA.
+	*/
+	Node* pop_Free() noexcept {
+		Node* node = freeNodes.load(std::memory_order_acquire);
+		while (node && !freeNodes.compare_exchange_weak(node, node->next.load(std::memory_order_relaxed), std::memory_order_acquire, std::memory_order_acquire)){
+
+		}
+		return node;
+	}
+
+	Node* allocate_Node(ElementT& obj, PinSlot& pinSlot) {
+		if (pinSlot.chunkPos == pinSlot.chunkEnd){
+			if (Node* const node = pop_Free()){
+				node->reset(&obj);
+				return node;
+			}
+			take_Chunk(pinSlot);
+		}
+		return ::new (static_cast<void*>(pinSlot.chunkPos++)) Node(&obj);
+	}
+
+	/*
+		slab i holds FIRST_SLAB_SIZE << i nodes and starts at the node index FIRST_SLAB_SIZE * (2^i - 1),
+		so that a chunk never crosses the end of a slab. the first chunk of a slab, that is not there yet, allocates it.
+	*/
+	void take_Chunk(PinSlot& pinSlot) {
+		const std::size_t first = allocatedCnt.fetch_add(ALLOCATION_CHUNK, std::memory_order_relaxed);
+		const std::size_t slab = static_cast<std::size_t>(std::bit_width(first / FIRST_SLAB_SIZE + 1)) - 1;
+		const std::size_t slabFirst = FIRST_SLAB_SIZE * ((std::size_t{1} << slab) - 1);
+
+		Node* nodes = slabs[slab].load(std::memory_order_acquire);
+		if (nodes == nullptr){
+			Node* const allocated = std::allocator<Node>().allocate(get_slabSize(slab));
+			if (slabs[slab].compare_exchange_strong(nodes, allocated, std::memory_order_acq_rel, std::memory_order_acquire)){
+				nodes = allocated;
+			} else {
+				std::allocator<Node>().deallocate(allocated, get_slabSize(slab));
+			}
+		}
+		pinSlot.chunkPos = nodes + (first - slabFirst);
+		pinSlot.chunkEnd = pinSlot.chunkPos + ALLOCATION_CHUNK;
+	}
+
+	std::atomic<Node*> root{nullptr};
+	std::atomic<uint_fast64_t> globalEpoch{1};
+	std::atomic<Node*> retired{nullptr};
+	std::atomic<Node*> freeNodes{nullptr};
+	std::atomic<std::size_t> allocatedCnt{0};
+	std::atomic<Node*> slabs[MAX_SLABS]{};
+	mutable PinSlot pinSlots[PIN_SLOTS]{};
+};
+
+/*
+	a Concurrent_K_Tree, that compares with the array compArr of PROPERTIES_CNT function pointers, see K_Tree.
+*/
+template<typename ElementT, uint_fast8_t PROPERTIES_CNT, const auto& compArr>
+using Concurrent_K_Tree_FunctionArray = Concurrent_K_Tree<ElementT, K_TreeFunctionArray<ElementT, PROPERTIES_CNT, compArr>>;
+
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef TASKGRAPH_HPP
+#define TASKGRAPH_HPP
+
+/*
+
+-- Part of KozyLibrary/DataStructures
+
+*/
+
+#include <cstdint>
+#include <atomic>
+#include <utility>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+
+#include "ThreadPool.hpp"
+
+
+namespace KozyLibrary {
+
+/*
+* DESCRIPTION *
+
+A directed acyclic graph of work, that is executed by a ThreadPool.
+A node is dispatched as soon as all of its predecessors finished. There are no global phases or barriers.
+
+The graph is built once with add_Node() and add_Edge() and may then be run any number of times.
+The first run after a change compiles the graph into flat arrays. Every later run only resets one counter per node and does not allocate.
+
+Assumptions:
+- a graph is not changed and not run twice at the same time, while it is running.
+- the ThreadPool outlives every run.
+
+
+* OTHER *
+
+nodeID				: the index of a node, in the order the nodes were added.
+
+*/
+class TaskGraph {
+public:
+	using nodeID = uint_fast32_t;
+	using voidFunc = std::function<void()>;
+
+	inline static constexpr nodeID NO_NODE = static_cast<nodeID>(-1);
+
+
+	TaskGraph() = default;
+
+	TaskGraph(const TaskGraph&) = delete;
+	TaskGraph& operator=(const TaskGraph&) = delete;
+
+	/*
+		adds a node, that calls fn every time the graph runs.
+	*/
+	template<typename FuncT>
+	nodeID add_Node(FuncT&& fn) {
+		work.emplace_back(std::forward<FuncT>(fn));
+		isCompiled = false;
+		return static_cast<nodeID>(work.size() - 1);
+	}
+
+	/*
+		to starts only after from finished.
+		UB if one of them is not a node of this graph.
+	*/
+	void add_Edge(nodeID from, nodeID to) {
+		edges.emplace_back(from, to);
+		isCompiled = false;
+	}
+
+	/*
+		runs every node once and returns, when all of them finished.
+		the calling thread executes pending work of pool in the meantime. If pool is not running, the calling thread executes the whole graph.
+
+		if a node throws, the nodes that did not start yet are skipped and the first exception is rethrown.
+		throws std::logic_error if the graph has a cycle.
+	*/
+	void run(ThreadPool& pool) {
+		compile();
+		if (work.empty()){
+			return;
+		}
+
+		hasFailed = false;
+		exception = nullptr;
+
+		if (!pool.is_running()){
+			for (nodeID id : topologicalOrder){
+				execute_Work(id);
+			}
+		} else {
+			for (nodeID id = 0, cnt = get_nodeCnt(); id != cnt; ++id){
+				pendingPredecessors[id].store(predecessorCnt[id], std::memory_order_relaxed);
+			}
+			remainingCnt = get_nodeCnt();
+			runningPool = &pool;
+
+			for (nodeID id : topologicalOrder){
+				if (predecessorCnt[id] != 0){
+					break; // the roots come first in topological order
+				}
+				dispatch(id);
+			}
+
+			pool.help_until([this](){ return remainingCnt.load() == 0; });
+			runningPool = nullptr;
+		}
+
+		if (hasFailed){
+			std::rethrow_exception(exception);
+		}
+	}
+
+	nodeID get_nodeCnt() const noexcept {
+		return static_cast<nodeID>(work.size());
+	}
+
+	std::size_t get_edgeCnt() const noexcept {
+		return edges.size();
+	}
+
+	/*
+		removes all nodes and edges.
+	*/
+	void clear() {
+		work.clear();
+		edges.clear();
+		isCompiled = false;
+	}
+
+private:
+
+	/*
+		builds the successor lists as one flat array and checks for cycles with Kahn's algorithm.
+	*/
+	void compile() {
+		if (isCompiled){
+			return;
+		}
+
+		const nodeID cnt = get_nodeCnt();
+		successorBegin.assign(cnt + 1, 0);
+		successors.resize(edges.size());
+		predecessorCnt.assign(cnt, 0);
+		pendingPredecessors.reset(new std::atomic<uint_fast32_t>[cnt]);
+
+		for (const auto& e : edges){
+			++successorBegin[e.first + 1];
+			++predecessorCnt[e.second];
+		}
+		for (nodeID id = 0; id != cnt; ++id){
+			successorBegin[id + 1] += successorBegin[id];
+		}
+		std::vector<std::size_t> fill(successorBegin.begin(), successorBegin.end() - 1);
+		for (const auto& e : edges){
+			successors[fill[e.first]++] = e.second;
+		}
+
+		topologicalOrder.clear();
+		topologicalOrder.reserve(cnt);
+		std::vector<uint_fast32_t> inDegree(predecessorCnt);
+		for (nodeID id = 0; id != cnt; ++id){
+			if (inDegree[id] == 0){
+				topologicalOrder.push_back(id);
+			}
+		}
+		for (std::size_t pos = 0; pos != topologicalOrder.size(); ++pos){
+			const nodeID id = topologicalOrder[pos];
+			for (std::size_t succ = successorBegin[id]; succ != successorBegin[id + 1]; ++succ){
+				if (--inDegree[successors[succ]] == 0){
+					topologicalOrder.push_back(successors[succ]);
+				}
+			}
+		}
+		if (topologicalOrder.size() != cnt){
+			throw std::logic_error(
+				"Error: TaskGraph.\n"
+				"The graph has a cycle!"
+			);
+		}
+
+		isCompiled = true;
+	}
+
+	void dispatch(nodeID id) {
+		runningPool->push_Work(ThreadPool::WorkItem([this, id](){ execute_Node(id); }));
+	}
+
+	void execute_Work(nodeID id) noexcept {
+		if (hasFailed.load(std::memory_order_relaxed)){
+			return;
+		}
+		try {
+			work[id]();
+		} catch (...) {
+			if (!hasFailed.exchange(true)){
+				exception = std::current_exception();
+			}
+		}
+	}
+
+	/*
+		executes a node and releases its successors.
+		the first successor that becomes ready is executed right away on the same thread, the others are dispatched.
+	*/
+	void execute_Node(nodeID id) {
+		ThreadPool& pool = *runningPool; // this graph may be destroyed as soon as remainingCnt is 0
+
+		while (id != NO_NODE){
+			execute_Work(id);
+
+			nodeID next = NO_NODE;
+			for (std::size_t succ = successorBegin[id]; succ != successorBegin[id + 1]; ++succ){
+				const nodeID successor = successors[succ];
+				if (--pendingPredecessors[successor] == 0){
+					if (next == NO_NODE){
+						next = successor;
+					} else {
+						dispatch(successor);
+					}
+				}
+			}
+
+			if (--remainingCnt == 0){
+				pool.notify_Progress();
+			}
+			id = next;
+		}
+	}
+
+	std::vector<voidFunc> work{};
+	std::vector<std::pair<nodeID, nodeID>> edges{};
+
+	// compiled form
+	bool isCompiled{false};
+	std::vector<std::size_t> successorBegin{};
+	std::vector<nodeID> successors{};
+	std::vector<uint_fast32_t> predecessorCnt{};
+	std::vector<nodeID> topologicalOrder{};
+	std::unique_ptr<std::atomic<uint_fast32_t>[]> pendingPredecessors{};
+
+	// state of the current run
+	ThreadPool* runningPool{nullptr};
+	std::atomic<nodeID> remainingCnt{0};
+	std::atomic<bool> hasFailed{false};
+	std::exception_ptr exception{};
+};
+
+}
+
+#endif
@@ -9,32 +9,182 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <exception>
+#include <future>
+#include <cstddef>
+#include <optional>
+#include <initializer_list>
+#include <iterator>
+#include <coroutine>
+#include <bit>
+#include <string>
+#include <typeinfo>
+#include <algorithm>
+
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "OptionalMember.hpp"
 
 
 namespace KozyLibrary {
 
+class TaskGraph;
 
 class ThreadPool {
 private:
 	struct WorkerThread;
 	friend struct WorkerThread;
+	friend class TaskGraph;
+
+	struct WorkQueue;
+	struct SubmissionQueue;
+	struct WorkerCounters;
+	struct StateSlab;
+	struct FutureStateBase;
+	template<typename ResultT> struct FutureState;
 
 	using threadCntT = uint_fast16_t; // only use unsigned types
 	inline static constexpr threadCntT threadCntT_MAX_VALUE = threadCntT(-2);
 
+	/*
+		what the parallel algorithms pass to their function for an index range or an iterator range.
+	*/
+	template<typename IteratorT> struct RangeElement { using type = std::iter_reference_t<IteratorT>; };
+	template<typename IteratorT> requires std::is_integral_v<IteratorT> struct RangeElement<IteratorT> { using type = IteratorT; };
+
 public:
 	using voidFunc = std::function<void()>;
 
+	/*
+		define KOZYLIBRARY_THREADPOOL_STATS before including this header, to let every worker collect WorkerStats.
+		otherwise the counters and timestamps are compiled out and only the counts, that ThreadPool needs anyway, are reported.
+	*/
+#ifdef KOZYLIBRARY_THREADPOOL_STATS
+	inline static constexpr bool IS_COLLECTING_STATS = true;
+#else
+	inline static constexpr bool IS_COLLECTING_STATS = false;
+#endif
+
+	class WorkItem;
+	template<typename ResultT> class Future;
+
+	/*
+		what a worker does while there is no work for it.
+
+		pausingWork	: calls the pausingWork function in a loop, see set_pausingWork()
+		parking		: spins for a short time, that adapts to how often work shows up while spinning, 
+					then blocks until work is added. an idle ThreadPool does not use any CPU.
+	*/
+	enum class IdleStrategy : uint_fast8_t {
+		pausingWork,
+		parking
+	};
+
+	/*
+		what add_Workload() and submit() do if the submission queue is full.
+
+		block		: the calling thread blocks until a worker took work out of the submission queue.
+		spin		: the calling thread yields in a loop until there is space.
+		reject		: the work is dropped and add_Workload() returns false.
+	*/
+	enum class Backpressure : uint_fast8_t {
+		block,
+		spin,
+		reject
+	};
+
+	/*
+		the lane that work is added to. Workers take work from higher lanes first:
+		high lane, their own queue, normal lane, queues of other workers, low lane.
+
+		a lane that was passed over AGING_LIMIT times while it held work, is served first once, so that no lane starves.
+		a worker adds normal work to its own queue, high and low work to the lane, as long as there is space in it.
+	*/
+	enum class Priority : uint_fast8_t {
+		high,
+		normal,
+		low
+	};
+
+	inline static constexpr std::size_t PRIORITY_CNT = 3;
+	inline static constexpr uint_fast32_t AGING_LIMIT = 32;
+
+	/*
+		where the workers run.
+
+		none		: wherever the OS puts them.
+		cpuSets		: worker i is pinned to the cpus of Placement::cpuSets[i % cpuSets.size()].
+		numaNodes	: worker i is pinned to all cpus of NUMA node i % get_numaNodes().size().
+					a worker steals from the workers of its own node first.
+	*/
+	enum class PlacementPolicy : uint_fast8_t {
+		none,
+		cpuSets,
+		numaNodes
+	};
+
+	/*
+		onWorkerStart is called by every worker thread, after it was pinned and before it takes work, with the id and NUMA node of the worker.
+		memory that it allocates and touches first is usually placed on that node by the OS.
+
+		pinning only works on Linux and is ignored elsewhere, or if the OS refuses it.
+	*/
+	struct Placement {
+		PlacementPolicy policy{PlacementPolicy::none};
+		std::vector<std::vector<unsigned>> cpuSets{};
+		std::function<void(threadCntT workerID, unsigned node)> onWorkerStart{};
+	};
+
+	/*
+		how much work the submission queue of each lane holds by default.
+	*/
+	inline static constexpr std::size_t DEFAULT_SUBMISSION_CAPACITY = 4096;
+
 
 	/*
 
 	*/
-	ThreadPool()
+	ThreadPool(): ThreadPool(DEFAULT_SUBMISSION_CAPACITY)
+    {
+
+    }
+
+	/*
+		submissionCapacity is the capacity of the submission queue of each lane, rounded up to a power of 2.
+	*/
+	explicit ThreadPool(std::size_t submissionCapacity, Backpressure arg_backpressure = Backpressure::block):
+		submission{SubmissionQueue(submissionCapacity), SubmissionQueue(submissionCapacity), SubmissionQueue(submissionCapacity)},
+		backpressure(arg_backpressure),
+		stateSlab(new StateSlab)
     {
 
     }
 
-	// TODO : add more constuctors : initializer_list with work, rvalue vector, etc.
+	/*
+		the work is processed once the ThreadPool is started.
+	*/
+	ThreadPool(std::initializer_list<voidFunc> work): ThreadPool()
+	{
+		add_Workloads(work);
+	}
+
+	/*
+		the work is processed once the ThreadPool is started.
+	*/
+	explicit ThreadPool(std::vector<voidFunc>&& work): ThreadPool()
+	{
+		add_Workloads(std::move(work));
+	}
 
 	/*
 
@@ -42,6 +192,13 @@ public:
 	~ThreadPool() {
 		stop();
 		wait_untilStopped();
+		startupWL.clear(); // breaks the promises of work that never ran
+		for (auto& lane : submission){
+			for (WorkItem item{}; lane.pop(item); ){
+				item.reset();
+			}
+		}
+		stateSlab->release();
     }
 
 	/*
@@ -49,30 +206,43 @@ public:
 		Invalid value for workerCnt gets corrected.
 	*/
 	void start(threadCntT workerCnt = recommended_ThreadsCnt) {
-		if (workerCnt > MAX_THREADS){
-			workerCnt = MAX_THREADS;
+		if (workerCnt > WORKER_SLOT_CNT){
+			workerCnt = WORKER_SLOT_CNT;
 		} else if (workerCnt == 0){
 			workerCnt = 1;
 		}
 		
 		worker.clear();
-		worker.reserve(workerCnt);
+		worker.reserve(WORKER_SLOT_CNT); // every slot exists up front, so that grow() never moves a worker
 
-		while (workerCnt-- != 0){
-			worker.emplace_back(WorkerThread(*this));
+		for (threadCntT id = 0; id != WORKER_SLOT_CNT; ++id){
+			worker.emplace_back(WorkerThread(*this, id));
 		}
+		place_Workers();
 
-		worker.shrink_to_fit();
 		requestTerminate = false;
 		isPaused = false;
 		pauseCounter = 0;
 
-		workPivot = activeWL->data();
-		workEndPivot = workPivot + activeWL->size();
-
-
-		for (auto& e : worker){
-			e.start();
+		startupGuard.lock();
+		for (auto& e : startupWL){ // work that was added before start() is spread across all queues
+			worker[submitCursor++ % workerCnt].queue.push(std::move(e));
+		}
+		startupWL.clear();
+		externalFinishedCnt = 0;
+		for (const auto& lane : submission){ // the lanes keep counting across restarts, everything in them was finished before
+			externalFinishedCnt += lane.get_pushCnt();
+		}
+		targetCnt = workerCnt;
+		activeCnt = workerCnt;
+		slotCnt = workerCnt;
+		queueCnt = workerCnt;
+		aliveCnt = workerCnt;
+		startupGuard.unlock();
+
+		for (threadCntT id = 0; id != workerCnt; ++id){
+			worker[id].isActive = true;
+			worker[id].start();
 		}
 		
 	}
@@ -85,21 +255,38 @@ public:
 
 		if you want to restart, use the method restart() instead,
 		so that there are no data races.
+
+		does nothing if this ThreadPool is not running or already stopping.
 	*/
 	void stop() {
-		std::thread finisherThread(stopFinisher, this);
-		finisherThread.detach();
+		std::lock_guard lock(stopGuard);
+		if (!is_running() || isStopping){
+			return;
+		}
+		isStopping = true;
+		isStopping.notify_all();
+		finisherThread = std::thread(stopFinisher, this);
 	}
 
 	
 
 	/*
-		the calling thread waits until this ThreadPool is stopped.
+		the calling thread blocks until this ThreadPool is stopped.
 		May lead to an infinite loop, if the method stop() is never called at some point.
 	*/
 	void wait_untilStopped() const {
-		while (is_running()){
-			pausingWork_default();
+		while (true){
+			{
+				std::lock_guard lock(stopGuard);
+				if (finisherThread.joinable()){
+					finisherThread.join();
+					return;
+				}
+				if (!is_running()){
+					return;
+				}
+			}
+			isStopping.wait(false);
 		}
 	}
 
@@ -118,14 +305,19 @@ public:
 
 	*/
 	bool is_running() const {
-		return worker.size() != 0;
+		return queueCnt != 0;
 	}
 
 	/*
 		pauses all workers as soon as possible.
 	*/
 	void pause() const {
-		pauseCounter = static_cast<threadCntT>(worker.size());
+		{
+			std::lock_guard lock(resizeGuard);
+			pauseCounter = activeCnt.load();
+			++pauseEpoch;
+		}
+		wake_All();
 	}
 
 	/*
@@ -133,6 +325,7 @@ public:
 	*/
 	void unpause() const {
 		isPaused = false;
+		isPaused.notify_all();
 	}
 
 	/*
@@ -144,12 +337,12 @@ public:
 	}
 
 	/*
-		the calling thread waits until this ThreadPool is paused.
+		the calling thread blocks until this ThreadPool is paused.
 		May lead to an infinite loop, if the method pause() is never called at some point.
 	*/
 	inline void wait_untilPaused() const {
 		while (!is_paused()){
-			pausingWork_default();
+			isPaused.wait(false);
 		}
 	}
 
@@ -158,6 +351,10 @@ public:
 		2^16 is a hard limit. 
 	*/
 	inline static const threadCntT MAX_THREADS { static_cast<threadCntT>((std::thread::hardware_concurrency() >= threadCntT_MAX_VALUE)? threadCntT_MAX_VALUE: std::thread::hardware_concurrency()) };
+	/*
+		How many workers a ThreadPool holds at most: MAX_THREADS, but at least 1, as hardware_concurrency() may return 0.
+	*/
+	inline static const threadCntT WORKER_SLOT_CNT { std::max<threadCntT>(MAX_THREADS, 1) };
 	/*
 		A recommendation to how many threads should be used if there is only one ThreadPool instance being used.
 	*/
@@ -167,226 +364,2663 @@ public:
 
 	*/
 	threadCntT get_workerCnt() const noexcept {
-		return static_cast<threadCntT>(worker.size());
+		return targetCnt;
+	}
+
+	/*
+		starts cnt more workers, while the others keep processing work. a worker that is still retiring is kept instead.
+		the count is capped at WORKER_SLOT_CNT. returns how many workers were added.
+		does nothing if this ThreadPool is not running.
+	*/
+	threadCntT grow(threadCntT cnt = 1) {
+		std::lock_guard lock(resizeGuard);
+		return grow_Locked(cnt);
 	}
 
 	/*
+		retires the cnt workers with the highest ids. each of them finishes its current work and leaves the work in its queue to the others.
+		at least one worker is kept. returns right away, with how many workers are going to retire.
+		does nothing if this ThreadPool is not running.
+	*/
+	threadCntT shrink(threadCntT cnt = 1) {
+		std::lock_guard lock(resizeGuard);
+		return shrink_Locked(cnt);
+	}
 
+	/*
+		grows or shrinks this ThreadPool to workerCnt workers, see grow() and shrink().
 	*/
-	void add_Workload(voidFunc fn) {
-		swapGuard.lock();
-		sleepingWL->emplace_back(std::move(fn));
-		swapGuard.unlock();
+	void resize(threadCntT workerCnt) {
+		std::lock_guard lock(resizeGuard);
+		if (workerCnt > targetCnt){
+			grow_Locked(static_cast<threadCntT>(workerCnt - targetCnt));
+		} else {
+			shrink_Locked(static_cast<threadCntT>(targetCnt - workerCnt));
+		}
 	}
 
+	/*
+		bounds of the autoscaling, see set_autoscaling().
 
-	inline static constexpr auto pausingWork_default = []()->void {
-		std::this_thread::sleep_for(std::chrono::microseconds(1));	
+		growDepth	: a worker is added, while more work than growDepth per worker is waiting in the queues.
+		retireAfter	: a worker is retired, after some worker found no work for this long.
+	*/
+	struct Autoscaling {
+		threadCntT minCnt{1};
+		threadCntT maxCnt{threadCntT_MAX_VALUE};
+		std::size_t growDepth{64};
+		std::chrono::milliseconds retireAfter{1000};
 	};
 
 	/*
-		restarts the threadpool and then changes pausingWork function.
-		this might take some time, if the Threadpool is running.
-			
+		lets the workers grow and shrink this ThreadPool on their own, between minCnt and maxCnt workers.
+		busy workers check the queue depth every AUTOSCALE_INTERVAL work, idle workers check how long they were idle.
+		start() and restarts keep the setting.
 	*/
-	template<typename voidFuncT>
-	void set_pausingWork(voidFuncT&& fn = ThreadPool::pausingWork_default) {
-		pausingWork = std::forward<voidFuncT>(fn);
-		restart(worker.size());
+	void set_autoscaling(const Autoscaling& settings) {
+		std::lock_guard lock(resizeGuard);
+		autoscaling = settings;
+		retireAfterNs = std::chrono::duration_cast<std::chrono::nanoseconds>(settings.retireAfter).count();
+		isAutoscaling = true;
 	}
 
-private:
+	void disable_autoscaling() {
+		isAutoscaling = false;
+	}
+
+	bool is_autoscaling() const noexcept {
+		return isAutoscaling;
+	}
+
+	inline static constexpr uint_fast32_t AUTOSCALE_INTERVAL = 64;
 
 	/*
-		pauses the workers and when they are synchronized, as in all paused, lets them terminate
+		a worker of this ThreadPool pushes into its own queue, any other thread pushes into the submission queue of the lane of priority, 
+		which the workers empty before they steal from each other.
+		work that is added before start() is kept until the workers exist, but loses its priority.
+
+		if the submission queue is full, the Backpressure policy decides what happens. 
+		returns false if the work was rejected.
 	*/
-	static void stopFinisher(ThreadPool* poolPtr) {
-		ThreadPool& pool = *poolPtr;
-		
-		pool.pause();
-		pool.requestTerminate = true;
-		pool.wait_untilPaused();
-		pool.unpause();
+	bool add_Workload(voidFunc fn, Priority priority = Priority::normal) {
+		return push_Work(WorkItem(std::move(fn)), false, priority);
+	}
 
-		pool.worker.clear();
+	/*
+		adds every callable of [first, last) as work, like add_Workload() does, but in chunks:
+		each chunk takes one lock, or claims consecutive positions of the submission queue with one CAS, 
+		and wakes as many parked workers as it brought work.
+		the callables are moved out of the range.
+
+		returns how many callables were added. callables that the Backpressure policy rejects are dropped.
+	*/
+	template<typename IteratorT>
+	std::size_t add_Workloads(IteratorT first, IteratorT last, Priority priority = Priority::normal) {
+		if constexpr (std::forward_iterator<IteratorT>){
+			if (!is_running()){ // work before start() goes into one vector, that grows once
+				std::lock_guard lock(startupGuard);
+				startupWL.reserve(startupWL.size() + static_cast<std::size_t>(std::distance(first, last)));
+			}
+		}
+
+		WorkItem chunk[BULK_CHUNK_SIZE];
+		std::size_t addedCnt = 0;
+		while (first != last){
+			std::size_t cnt = 0;
+			for (; cnt != BULK_CHUNK_SIZE && first != last; ++cnt, ++first){
+				chunk[cnt] = WorkItem(std::move(*first));
+			}
+			addedCnt += push_Chunk(chunk, cnt, priority);
+		}
+		return addedCnt;
 	}
 
+	/*
+		see add_Workloads(first, last). the callables are copied.
+	*/
+	std::size_t add_Workloads(std::initializer_list<voidFunc> work, Priority priority = Priority::normal) {
+		return add_Workloads(work.begin(), work.end(), priority);
+	}
 
-	struct WorkerThread {
+	/*
+		see add_Workloads(first, last).
+	*/
+	std::size_t add_Workloads(std::vector<voidFunc>&& work, Priority priority = Priority::normal) {
+		const std::size_t addedCnt = add_Workloads(work.begin(), work.end(), priority);
+		work.clear();
+		return addedCnt;
+	}
 
-		template<typename voidFuncT>
-		WorkerThread(
-			ThreadPool& arg_threadpool,
-			std::thread&& arg_executionThread, 
-			voidFuncT&& arg_pausingWorkCopy
-		):
-			threadpool(arg_threadpool),
-			executionThread(std::move(arg_executionThread)),
-			pausingWorkCopy(std::forward<voidFuncT>(arg_pausingWorkCopy))
-		{
+	/*
+		adds fn(args...) as work and returns a handle to its result.
+		fn and args are stored by value inside a WorkItem and the result inside a slab of this ThreadPool,
+		so that neither needs a heap allocation as long as they are small enough.
+
+		an exception thrown by fn is rethrown by Future::get().
+		work that is never executed, because this ThreadPool is destroyed before it was started or because the Backpressure policy rejected it,
+		throws std::future_error with broken_promise.
+		UB if the returned Future outlives this ThreadPool while it is still waited on.
+	*/
+	template<typename FuncT, typename... ArgsT>
+	auto submit(FuncT&& fn, ArgsT&&... args) -> Future<std::invoke_result_t<std::decay_t<FuncT>, std::decay_t<ArgsT>...>> {
+		return submit(Priority::normal, std::forward<FuncT>(fn), std::forward<ArgsT>(args)...);
+	}
 
-		}
 
-		WorkerThread(ThreadPool& pool): WorkerThread(pool, std::thread{}, pool.pausingWork)
+	/*
+		submit() into the lane of priority.
+	*/
+	template<typename FuncT, typename... ArgsT>
+	auto submit(Priority priority, FuncT&& fn, ArgsT&&... args) -> Future<std::invoke_result_t<std::decay_t<FuncT>, std::decay_t<ArgsT>...>> {
+		using ResultT = std::invoke_result_t<std::decay_t<FuncT>, std::decay_t<ArgsT>...>;
+
+		FutureState<ResultT>* const state = FutureState<ResultT>::create(*stateSlab);
+		push_Work(WorkItem(
+			[promise = typename FutureState<ResultT>::Promise(state), fn = std::forward<FuncT>(fn), ...args = std::forward<ArgsT>(args)]() mutable {
+				promise.run(fn, args...);
+			}
+		), false, priority);
+		return Future<ResultT>(state);
+	}
+
+	/*
+		an awaitable, that suspends the awaiting coroutine and resumes it as work of the ThreadPool, in the lane of priority:
+			co_await pool.schedule();
+		only the coroutine handle is stored inside the WorkItem, so resuming neither boxes into a voidFunc nor allocates.
+		never rejected by the Backpressure policy, because a rejected coroutine would never be resumed.
+		if the ThreadPool is not running, the coroutine is not suspended and continues on the awaiting thread, like parallel_for() does.
+		otherwise its handle would wait for start() as work, and be dropped without destroying its frame, if the ThreadPool is destroyed first.
+	*/
+	class ScheduleAwaiter {
+	public:
+		ScheduleAwaiter(ThreadPool& arg_pool, Priority arg_priority) noexcept:
+			pool(arg_pool),
+			priority(arg_priority)
 		{
 
 		}
 
-		WorkerThread(const WorkerThread& cpy): WorkerThread(cpy.threadpool, std::thread{}, cpy.pausingWorkCopy)
-		{
+		bool await_ready() const noexcept {
+			return false;
+		}
 
+		bool await_suspend(std::coroutine_handle<> awaiting) {
+			if (!pool.is_running()){
+				return false;
+			}
+			pool.push_Work(WorkItem([awaiting](){ awaiting.resume(); }), true, priority);
+			return true;
 		}
 
-		WorkerThread(WorkerThread&& mv): WorkerThread(mv.threadpool, std::move(mv.executionThread), std::move(mv.pausingWorkCopy))
-		{
+		void await_resume() const noexcept {
 
 		}
 
-		~WorkerThread() {
-			if (executionThread.joinable()){ 
-				executionThread.join();
-			}
-		}
+	private:
+		ThreadPool& pool;
+		Priority priority;
+	};
 
-		/*
+	ScheduleAwaiter schedule(Priority priority = Priority::normal) noexcept {
+		return ScheduleAwaiter(*this, priority);
+	}
+
+	/*
+		a handle to work, that was scheduled for later with schedule_after(), schedule_at() or schedule_every().
+		copies refer to the same timer. UB if it is used after its ThreadPool was destroyed.
+	*/
+	class Timer {
+	public:
+		Timer() noexcept = default;
 
+		/*
+			returns true if the timer was still pending, then its work does not run (again).
+			work of the timer, that was already handed to the workers, still runs.
 		*/
-		void start() {
-			executionThread = std::move(std::thread(work, this));
-			
+		bool cancel() {
+			if (!pool){
+				return false;
+			}
+			std::lock_guard lock(pool->timerGuard);
+			const bool res = pool->timers.cancel(index, generation);
+			pool->update_nextTimer();
+			return res;
 		}
 
-		inline void stop() {
-			threadpool.stop();
+		bool is_valid() const noexcept {
+			return pool != nullptr;
 		}
 
-		inline void pause() {
-			threadpool.pause();
-		}
+	private:
+		friend class ThreadPool;
 
-		inline void unpause() {
-			threadpool.unpause();
-		}
+		Timer(ThreadPool* arg_pool, uint_fast32_t arg_index, uint_fast32_t arg_generation) noexcept:
+			pool(arg_pool),
+			index(arg_index),
+			generation(arg_generation)
+		{
 
-		/*
-			needs to be paused, else UB
-		*//*
-		template<typename voidFuncT>
-		void set_pausingWork(voidFuncT&& fn = ThreadPool::pausingWork_default) {
-			pausingWorkCopy = std::forward<voidFuncT>(fn);
 		}
-*/
-		/*
 
-		*/
-		static void work(WorkerThread* worker) {
-			WorkerThread& wref = *worker;
-			ThreadPool& pool = wref.threadpool;
-			static std::mutex workerGuard{};
-			threadCntT pauseID = 0;
-
-			while (!pool.requestTerminate){
-				while (pool.pauseCounter == 0){
-
-					workerGuard.lock();	
-					if (pool.workPivot == pool.workEndPivot){
-						workerGuard.unlock();
-
-						if (pool.sleepingWL->empty() && pool.pauseCounter == 0){
-							wref.pausingWorkCopy();
-						} else {
-							static std::atomic<threadCntT> workerCounter {0};
-							if (++workerCounter == 1){
-								pool.activeWL->clear();
-
-								pool.swapGuard.lock();
-								std::swap(pool.activeWL, pool.sleepingWL);
-								pool.swapGuard.unlock();
-
-								workerGuard.lock();
-								pool.workPivot = pool.activeWL->data();
-								pool.workEndPivot = pool.workPivot + pool.activeWL->size();
-								workerGuard.unlock();
-								workerCounter = 0;
-							}
-						}
+		ThreadPool* pool{nullptr};
+		uint_fast32_t index{0};
+		uint_fast32_t generation{0};
+	};
 
-					} else {
-						voidFunc workValue = std::move(*pool.workPivot++);
-						workerGuard.unlock();
-						
-						workValue();
-					}
-					
-				}
+	/*
+		the workers hand the work of a timer to the high lane, once it expired, and as early as the next TIMER_TICK.
+		timers that expire in the same tick are handed over together.
+		timers are kept while this ThreadPool is stopped, and expire once it runs again.
+	*/
+	inline static constexpr std::chrono::nanoseconds TIMER_TICK{std::chrono::milliseconds(1)};
+
+	/*
+		runs fn once, after delay.
+	*/
+	template<typename RepT, typename PeriodT, typename FuncT>
+	Timer schedule_after(std::chrono::duration<RepT, PeriodT> delay, FuncT&& fn) {
+		return add_Timer(std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count(), 0, voidFunc(std::forward<FuncT>(fn)));
+	}
+
+	/*
+		runs fn once, at timePoint of any clock.
+	*/
+	template<typename ClockT, typename DurationT, typename FuncT>
+	Timer schedule_at(std::chrono::time_point<ClockT, DurationT> timePoint, FuncT&& fn) {
+		return schedule_after(timePoint - ClockT::now(), std::forward<FuncT>(fn));
+	}
+
+	/*
+		runs fn every period, the first time after one period, until the timer is cancelled.
+		runs that were missed, because the workers were busy or the pool was paused, are skipped.
+	*/
+	template<typename RepT, typename PeriodT, typename FuncT>
+	Timer schedule_every(std::chrono::duration<RepT, PeriodT> period, FuncT&& fn) {
+		const int_fast64_t periodNs = std::chrono::duration_cast<std::chrono::nanoseconds>(period).count();
+		return add_Timer(periodNs, periodNs, voidFunc(std::forward<FuncT>(fn)));
+	}
+
+	/*
+		how many timers are pending.
+	*/
+	std::size_t get_timerCnt() const {
+		std::lock_guard lock(timerGuard);
+		return timers.pendingCnt;
+	}
+
+	/*
+		calls fn(i) for every index i in [first, last), or fn(*iter) for every iterator in [first, last), and returns when all calls returned.
+		Iterators have to be random access iterators.
 
-				pauseID = --pool.pauseCounter;
-				if (pauseID == 0){
-					pool.isPaused = true;
+		the range is split into chunks of grainSize elements. 
+		if grainSize is 0, the chunk size is chosen so that every worker and the calling thread get several chunks.
+		chunks are claimed one after another by some workers and by the calling thread itself, 
+		and the calling thread executes other pending work while it waits for the last chunks.
+
+		if fn throws, the remaining chunks are skipped and the first exception is rethrown.
+	*/
+	template<typename IteratorT, typename FuncT>
+	void parallel_for(IteratorT first, IteratorT last, FuncT&& fn, std::size_t grainSize = 0) {
+		const std::size_t cnt = static_cast<std::size_t>(last - first);
+		for_eachChunk(cnt, get_chunkSize(cnt, grainSize), [&first, &fn](std::size_t begin, std::size_t end, std::size_t){
+			for (std::size_t pos = begin; pos != end; ++pos){
+				if constexpr (std::is_integral_v<IteratorT>){
+					fn(static_cast<IteratorT>(first + static_cast<IteratorT>(pos)));
 				} else {
-					while (pool.pauseCounter != 0){
-						wref.pausingWorkCopy();
-					}
+					fn(first[pos]);
 				}
+			}
+		});
+	}
 
-				while (pool.isPaused){
-					wref.pausingWorkCopy();
-				}
-				
+	/*
+		reduces transform(i) for every index i in [first, last), or transform(*iter) for every iterator in [first, last), with reduce and init.
+		the result is reduce(init, reduce(...reduce(transform(first), transform(first+1))...)) with an unspecified grouping,
+		so reduce has to be associative. The order of the elements is kept, so it does not have to be commutative.
+
+		see parallel_for() for grainSize, helping and exceptions.
+	*/
+	template<typename IteratorT, typename ResultT, typename ReduceT, typename TransformT> requires std::is_invocable_v<TransformT&, typename RangeElement<IteratorT>::type>
+	ResultT parallel_reduce(IteratorT first, IteratorT last, ResultT init, ReduceT&& reduce, TransformT&& transform, std::size_t grainSize = 0) {
+		const std::size_t cnt = static_cast<std::size_t>(last - first);
+		if (cnt == 0){
+			return init;
+		}
 
+		const auto element = [&first, &transform](std::size_t pos) -> decltype(auto) {
+			if constexpr (std::is_integral_v<IteratorT>){
+				return transform(static_cast<IteratorT>(first + static_cast<IteratorT>(pos)));
+			} else {
+				return transform(first[pos]);
+			}
+		};
+
+		// the chunk size depends on the worker count, that grow() and shrink() can change meanwhile, so it is chosen only once.
+		const std::size_t chunkSize = get_chunkSize(cnt, grainSize);
+		std::vector<std::optional<ResultT>> partial((cnt + chunkSize - 1) / chunkSize);
+		for_eachChunk(cnt, chunkSize, [&partial, &reduce, &element](std::size_t begin, std::size_t end, std::size_t chunk){
+			ResultT res = static_cast<ResultT>(element(begin));
+			for (std::size_t pos = begin + 1; pos != end; ++pos){
+				res = reduce(std::move(res), element(pos));
 			}
+			partial[chunk].emplace(std::move(res));
+		});
 
-			if (pauseID == 0){ // one thread finishes remaining work
-				
-				for (auto workPtr = pool.workPivot; pool.workPivot != pool.workEndPivot; workPtr = ++pool.workPivot){ // processing active work queue
-					(*workPtr)();
-				}
-				pool.activeWL->clear();
+		for (auto& e : partial){
+			init = reduce(std::move(init), std::move(*e));
+		}
+		return init;
+	}
+
+	/*
+		reduces the range with reduce, see the overload above.
+	*/
+	template<typename IteratorT, typename ResultT, typename ReduceT>
+	ResultT parallel_reduce(IteratorT first, IteratorT last, ResultT init, ReduceT&& reduce, std::size_t grainSize = 0) {
+		return parallel_reduce(first, last, std::move(init), std::forward<ReduceT>(reduce), [](const auto& e){ return e; }, grainSize);
+	}
+
+	/*
+		writes fn(i) for every index i in [first, last), or fn(*iter) for every iterator in [first, last), to out[0], out[1], ...
+		out has to be a random access iterator. Returns the end of the written range.
 
-				pool.swapGuard.lock();
-				for (auto& e : (*pool.sleepingWL)){ // processing most recent work. ANY WORK ADDED AFTER IS IGNORED 
-					e();
+		see parallel_for() for grainSize, helping and exceptions.
+	*/
+	template<typename IteratorT, typename OutputIteratorT, typename FuncT>
+	OutputIteratorT parallel_transform(IteratorT first, IteratorT last, OutputIteratorT out, FuncT&& fn, std::size_t grainSize = 0) {
+		const std::size_t cnt = static_cast<std::size_t>(last - first);
+
+		for_eachChunk(cnt, get_chunkSize(cnt, grainSize), [&first, &out, &fn](std::size_t begin, std::size_t end, std::size_t){
+			for (std::size_t pos = begin; pos != end; ++pos){
+				if constexpr (std::is_integral_v<IteratorT>){
+					out[pos] = fn(static_cast<IteratorT>(first + static_cast<IteratorT>(pos)));
+				} else {
+					out[pos] = fn(first[pos]);
 				}
-				pool.sleepingWL->clear();
-				pool.swapGuard.unlock();
+			}
+		});
+		return out + cnt;
+	}
 
+	/*
+		executes one piece of pending work of this ThreadPool on the calling thread, if there is any.
+		the work is chosen in the same order as a worker chooses it, see Priority.
+		returns false if there was no work.
+	*/
+	bool help_Once() {
+		WorkerThread* const self = WorkerThread::current(*this);
 
-			} 
-			
+		WorkItem item{};
+		if (take_Work(self, item)){
+			execute(item, self);
+			return true;
 		}
+		return false;
+	}
 
-		bool operator==(const WorkerThread& rhs) const {
-			return this == &rhs;
+	/*
+		returns true if all work, that was added until now, is finished.
+		always returns true if this ThreadPool is not running.
+	*/
+	bool is_idle() const {
+		if (!is_running()){
+			return true;
 		}
-		inline bool operator!=(const WorkerThread& rhs) const {
-			return !(*this == rhs);
+
+		// every piece of work is pushed before it finishes, so if the finished work is counted first, 
+		// both counts can only be equal if there was a moment in between without any pending work
+		uint_fast64_t finishedCnt = externalFinishedCnt.load();
+		for (const auto& e : worker){
+			finishedCnt += e.finishedCnt.load();
 		}
-		
-		bool operator==(const std::thread& rhs) const {
-			return executionThread.get_id() == rhs.get_id();
+		uint_fast64_t pushedCnt = 0;
+		for (const auto& lane : submission){
+			pushedCnt += lane.get_pushCnt();
 		}
-		inline bool operator!=(const std::thread& rhs) const {
-			return !(*this == rhs);
+		for (const auto& e : worker){
+			pushedCnt += e.queue.pushCnt.load();
 		}
+		return finishedCnt == pushedCnt;
+	}
 
-		std::thread executionThread;
-		voidFunc pausingWorkCopy;
-		ThreadPool& threadpool;
-	};
+	/*
+		the calling thread waits until all work, including the work that is added by that work, is finished.
+		the workers stay alive, unlike with stop() and wait_untilStopped().
+		the calling thread executes pending work in the meantime.
 
-	std::vector<WorkerThread> worker{};
+		returns immediately if this ThreadPool is not running.
+		May lead to an infinite loop, if other threads keep adding work. 
+		Deadlocks if it is called by work of this ThreadPool.
+	*/
+	void wait_idle() {
+		help_until([this](){ return is_idle(); });
+	}
 
-	std::vector<voidFunc> workload[2]{};
-	std::vector<voidFunc> * activeWL{workload}, * sleepingWL{workload +1};
-	voidFunc* workPivot{nullptr}, * workEndPivot{nullptr};
+	/*
+		a set of work, that can be waited on without waiting for any other work of the ThreadPool.
+		the TaskGroup may be reused after wait() returned.
 
-	voidFunc pausingWork {pausingWork_default};
+		the destructor waits for the remaining work of the group, but drops its exception.
+		UB if the ThreadPool is destroyed before the TaskGroup.
+	*/
+	class TaskGroup {
+	public:
+		explicit TaskGroup(ThreadPool& arg_pool) noexcept:
+			pool(arg_pool)
+		{
+
+		}
+
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		~TaskGroup() {
+			pool.help_until([this](){ return pendingCnt.load() == 0; });
+		}
+
+		/*
+			adds fn() as work of this group.
+		*/
+		template<typename FuncT>
+		void run(FuncT&& fn) {
+			++pendingCnt;
+			pool.push_Work(WorkItem([this, fn = std::forward<FuncT>(fn)]() mutable {
+				try {
+					fn();
+				} catch (...) {
+					if (!hasFailed.exchange(true)){
+						exception = std::current_exception();
+					}
+				}
+
+				ThreadPool& owner = pool; // this group may be destroyed as soon as pendingCnt is 0
+				if (--pendingCnt == 0){
+					owner.notify_Progress();
+				}
+			}));
+		}
+
+		/*
+			the calling thread waits until all work of this group is finished and executes pending work of the ThreadPool in the meantime.
+			rethrows the first exception that was thrown by work of this group.
+		*/
+		void wait() {
+			pool.help_until([this](){ return pendingCnt.load() == 0; });
+
+			if (hasFailed){
+				std::exception_ptr e = std::move(exception);
+				exception = nullptr;
+				hasFailed = false;
+				std::rethrow_exception(e);
+			}
+		}
+
+		bool is_done() const noexcept {
+			return pendingCnt.load() == 0;
+		}
+
+		std::size_t get_pendingCnt() const noexcept {
+			return pendingCnt.load();
+		}
+
+	private:
+		ThreadPool& pool;
+		std::atomic<std::size_t> pendingCnt{0};
+		std::atomic<bool> hasFailed{false};
+		std::exception_ptr exception{};
+	};
+
+	/*
+		how many chunks the parallel algorithms make for each worker and the calling thread, if the grain size is chosen automatically.
+	*/
+	inline static constexpr std::size_t CHUNKS_PER_THREAD = 8;
+
+	/*
+		how many callables add_Workloads() converts to work before it pushes them at once.
+	*/
+	inline static constexpr std::size_t BULK_CHUNK_SIZE = 64;
+
+
+	inline static constexpr auto pausingWork_default = []()->void {
+		std::this_thread::sleep_for(std::chrono::microseconds(1));	
+	};
+
+	/*
+		restarts the threadpool and then changes pausingWork function.
+		this might take some time, if the Threadpool is running.
+			
+	*/
+	template<typename voidFuncT>
+	void set_pausingWork(voidFuncT&& fn = ThreadPool::pausingWork_default) {
+		pausingWork = std::forward<voidFuncT>(fn);
+		restart(get_workerCnt());
+	}
+
+	/*
+		restarts the threadpool, if it is running, and then changes how idle workers wait for work.
+		the pausingWork function is still used by the parking strategy while paused or while waiting inside of work.
+	*/
+	void set_idleStrategy(IdleStrategy strategy) {
+		if (is_running()){
+			const threadCntT workerCnt = get_workerCnt();
+			stop();
+			wait_untilStopped();
+			idleStrategy = strategy;
+			start(workerCnt);
+		} else {
+			idleStrategy = strategy;
+		}
+	}
+
+	IdleStrategy get_idleStrategy() const noexcept {
+		return idleStrategy;
+	}
+
+	/*
+		restarts the threadpool, if it is running, and then changes where the workers run.
+	*/
+	void set_placement(Placement arg_placement) {
+		if (is_running()){
+			const threadCntT workerCnt = get_workerCnt();
+			stop();
+			wait_untilStopped();
+			placement = std::move(arg_placement);
+			start(workerCnt);
+		} else {
+			placement = std::move(arg_placement);
+		}
+	}
+
+	const Placement& get_placement() const noexcept {
+		return placement;
+	}
+
+	/*
+		the NUMA node, that a worker was placed on. 0 unless the policy is numaNodes.
+		UB if id is not smaller than get_workerCnt().
+	*/
+	unsigned get_workerNode(threadCntT id) const noexcept {
+		return worker[id].node;
+	}
+
+	/*
+		the cpus of every NUMA node, read from /sys/devices/system/node on Linux.
+		a single node with all cpus, if there is no NUMA information.
+	*/
+	static std::vector<std::vector<unsigned>> get_numaNodes() {
+		std::vector<std::vector<unsigned>> res;
+#ifdef __linux__
+		for (unsigned node = 0; ; ++node){
+			std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+			std::string cpuList;
+			if (!file || !std::getline(file, cpuList)){
+				break;
+			}
+			res.push_back(parse_cpuList(cpuList));
+		}
+#endif
+		if (res.empty()){
+			res.emplace_back();
+			for (unsigned cpu = 0, cnt = std::thread::hardware_concurrency(); cpu != cnt; ++cpu){
+				res.back().push_back(cpu);
+			}
+		}
+		return res;
+	}
+
+	/*
+		parses a list of cpus in the format of Linux, like "0-3,8,10-11".
+	*/
+	static std::vector<unsigned> parse_cpuList(const std::string& cpuList) {
+		std::vector<unsigned> res;
+		std::stringstream stream(cpuList);
+		for (std::string range; std::getline(stream, range, ','); ){
+			const std::size_t dash = range.find('-');
+			try {
+				const unsigned first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+				const unsigned last = (dash == std::string::npos)? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+				for (unsigned cpu = first; cpu <= last; ++cpu){
+					res.push_back(cpu);
+				}
+			} catch (const std::logic_error&) {
+				// an empty or broken range is skipped
+			}
+		}
+		return res;
+	}
+
+	/*
+		UB if other threads add work at the same time.
+	*/
+	void set_backpressure(Backpressure policy) noexcept {
+		backpressure = policy;
+	}
+
+	Backpressure get_backpressure() const noexcept {
+		return backpressure;
+	}
+
+	/*
+		of the submission queue of each lane.
+	*/
+	std::size_t get_submissionCapacity() const noexcept {
+		return submission[0].capacity;
+	}
+
+	/*
+		how much work waits in the submission queue of the lane of priority right now.
+		normal work, that workers added to their own queues, is not counted.
+	*/
+	std::size_t get_queueDepth(Priority priority) const noexcept {
+		return submission[static_cast<std::size_t>(priority)].get_depth();
+	}
+
+	/*
+		the highest depth, that the submission queue of the lane of priority had since the last reset_peakQueueDepth().
+	*/
+	std::size_t get_peakQueueDepth(Priority priority) const noexcept {
+		return submission[static_cast<std::size_t>(priority)].peakDepth.load(std::memory_order_relaxed);
+	}
+
+	void reset_peakQueueDepth() noexcept {
+		for (auto& lane : submission){
+			lane.peakDepth.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	/*
+		how many buckets the histograms of WorkerStats have.
+		bucket 0 counts durations of 0ns, bucket i counts durations in [2^(i-1), 2^i) ns, the last bucket also counts everything longer.
+	*/
+	inline static constexpr std::size_t HISTOGRAM_SIZE = 40;
+
+	/*
+		a snapshot of what one worker did since it was started. plain data, that can be copied and exported as it is.
+		the fields after queueDepth stay 0, unless IS_COLLECTING_STATS is true.
+
+		executedCnt				: work executed by this worker, including work it executed while waiting inside of other work.
+		localCnt				: work taken from its own queue.
+		submittedCnt			: work taken from the submission queues of the lanes.
+		stolenCnt				: work taken from the queues of other workers.
+		busyTime				: time spent executing work.
+		idleTime				: time spent spinning, parking or in the pausingWork function, because there was no work.
+		pausedTime				: time spent paused.
+		waitHistogram			: time from adding work until this worker started it.
+		runHistogram			: time that work ran on this worker.
+	*/
+	struct WorkerStats {
+		threadCntT id{0};
+		uint_fast64_t executedCnt{0};
+		std::size_t queueDepth{0};
+
+		uint_fast64_t localCnt{0};
+		uint_fast64_t submittedCnt{0};
+		uint_fast64_t stolenCnt{0};
+		std::chrono::nanoseconds busyTime{0};
+		std::chrono::nanoseconds idleTime{0};
+		std::chrono::nanoseconds pausedTime{0};
+		uint_fast64_t waitHistogram[HISTOGRAM_SIZE]{};
+		uint_fast64_t runHistogram[HISTOGRAM_SIZE]{};
+	};
+
+	/*
+		reads the counters of one worker with relaxed loads, without stopping it.
+		UB if id is not smaller than get_workerCnt(), or while this ThreadPool starts or stops.
+	*/
+	WorkerStats get_workerStats(threadCntT id) const noexcept {
+		const WorkerThread& w = worker[id];
+		WorkerStats res{};
+		res.id = id;
+		res.executedCnt = w.finishedCnt.load(std::memory_order_relaxed);
+		res.queueDepth = w.queue.cnt.load(std::memory_order_relaxed);
+
+		if constexpr (IS_COLLECTING_STATS){
+			const WorkerCounters& c = w.counters;
+			res.localCnt = c.localCnt.load(std::memory_order_relaxed);
+			res.submittedCnt = c.submittedCnt.load(std::memory_order_relaxed);
+			res.stolenCnt = c.stolenCnt.load(std::memory_order_relaxed);
+			res.busyTime = std::chrono::nanoseconds(c.busyNs.load(std::memory_order_relaxed));
+			res.idleTime = std::chrono::nanoseconds(c.idleNs.load(std::memory_order_relaxed));
+			res.pausedTime = std::chrono::nanoseconds(c.pausedNs.load(std::memory_order_relaxed));
+			for (std::size_t bucket = 0; bucket != HISTOGRAM_SIZE; ++bucket){
+				res.waitHistogram[bucket] = c.waitHistogram[bucket].load(std::memory_order_relaxed);
+				res.runHistogram[bucket] = c.runHistogram[bucket].load(std::memory_order_relaxed);
+			}
+		}
+		return res;
+	}
+
+	/*
+		get_workerStats() of every worker.
+	*/
+	std::vector<WorkerStats> get_stats() const {
+		std::vector<WorkerStats> res;
+		res.reserve(worker.size());
+		for (threadCntT id = 0, cnt = get_workerCnt(); id != cnt; ++id){
+			res.push_back(get_workerStats(id));
+		}
+		return res;
+	}
+
+	/*
+		the clock of all timestamps of the stats, in nanoseconds.
+	*/
+	static int_fast64_t get_timeNs() noexcept {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+
+	/*
+		a move-only callable without parameters and return value, that is stored by ThreadPool as work.
+
+		callables up to INLINE_SIZE bytes, that can be moved without throwing, are stored inside the WorkItem itself.
+		bigger callables are stored on the heap.
+		std::function always fits inline, so wrapping a voidFunc never allocates twice.
+	*/
+	class WorkItem {
+	public:
+		inline static constexpr std::size_t INLINE_SIZE = 64 - sizeof(void*);
+
+		template<typename FuncT>
+		inline static constexpr bool is_storedInline = 
+			sizeof(FuncT) <= INLINE_SIZE && 
+			alignof(FuncT) <= alignof(std::max_align_t) && 
+			std::is_nothrow_move_constructible_v<FuncT>;
+
+		WorkItem() noexcept = default;
+
+		template<typename FuncT> requires (!std::is_same_v<std::remove_cvref_t<FuncT>, WorkItem>)
+		WorkItem(FuncT&& fn) {
+			using T = std::decay_t<FuncT>;
+
+			if constexpr (is_storedInline<T>){
+				::new (static_cast<void*>(buffer)) T(std::forward<FuncT>(fn));
+				ops = &inlineOperations<T>;
+			} else {
+				*reinterpret_cast<T**>(buffer) = new T(std::forward<FuncT>(fn));
+				ops = &heapOperations<T>;
+			}
+			if constexpr (IS_COLLECTING_STATS){
+				static_cast<int_fast64_t&>(createTime) = get_timeNs();
+			}
+		}
+
+		WorkItem(WorkItem&& mv) noexcept:
+			ops(mv.ops)
+		{
+			if (ops){
+				ops->move(buffer, mv.buffer);
+				mv.ops = nullptr;
+			}
+			if constexpr (IS_COLLECTING_STATS){
+				static_cast<int_fast64_t&>(createTime) = static_cast<int_fast64_t&>(mv.createTime);
+			}
+		}
+
+		WorkItem& operator=(WorkItem&& mv) noexcept {
+			if (this != &mv){
+				reset();
+				if (mv.ops){
+					ops = mv.ops;
+					ops->move(buffer, mv.buffer);
+					mv.ops = nullptr;
+				}
+				if constexpr (IS_COLLECTING_STATS){
+					static_cast<int_fast64_t&>(createTime) = static_cast<int_fast64_t&>(mv.createTime);
+				}
+			}
+			return *this;
+		}
+
+		WorkItem(const WorkItem&) = delete;
+		WorkItem& operator=(const WorkItem&) = delete;
+
+		~WorkItem() {
+			reset();
+		}
+
+		/*
+			UB if there is no callable.
+		*/
+		inline void operator()() {
+			ops->invoke(buffer);
+		}
+
+		explicit operator bool() const noexcept {
+			return ops;
+		}
+
+		void reset() noexcept {
+			if (ops){
+				ops->destroy(buffer);
+				ops = nullptr;
+			}
+		}
+
+	private:
+
+		struct Operations {
+			void (*invoke)(void* buffer);
+			void (*move)(void* dst, void* src) noexcept;
+			void (*destroy)(void* buffer) noexcept;
+		};
+
+		template<typename T>
+		inline static constexpr Operations inlineOperations{
+			[](void* buffer){ (*static_cast<T*>(buffer))(); },
+			[](void* dst, void* src) noexcept { 
+				::new (dst) T(std::move(*static_cast<T*>(src)));
+				static_cast<T*>(src)->~T();
+			},
+			[](void* buffer) noexcept { static_cast<T*>(buffer)->~T(); }
+		};
+
+		template<typename T>
+		inline static constexpr Operations heapOperations{
+			[](void* buffer){ (**static_cast<T**>(buffer))(); },
+			[](void* dst, void* src) noexcept { *static_cast<T**>(dst) = *static_cast<T**>(src); },
+			[](void* buffer) noexcept { delete *static_cast<T**>(buffer); }
+		};
+
+		friend class ThreadPool;
+
+		alignas(std::max_align_t) unsigned char buffer[INLINE_SIZE];
+		const Operations* ops{nullptr};
+		Optional_Member<int_fast64_t, IS_COLLECTING_STATS> createTime{}; // when the work was added, see get_timeNs()
+	};
+
+
+	/*
+		a handle to the result of work that was added by submit().
+
+		get() waits for the result and moves it out, it may only be called once.
+		waiting inside a worker of a ThreadPool executes other pending work of that ThreadPool in the meantime,
+		so that a task waiting on another task can not starve the workers.
+		any other thread blocks until the result is ready.
+	*/
+	template<typename ResultT>
+	class Future {
+	public:
+		Future() noexcept = default;
+
+		Future(Future&& mv) noexcept:
+			state(mv.state)
+		{
+			mv.state = nullptr;
+		}
+
+		Future& operator=(Future&& mv) noexcept {
+			if (this != &mv){
+				reset();
+				state = mv.state;
+				mv.state = nullptr;
+			}
+			return *this;
+		}
+
+		Future(const Future&) = delete;
+		Future& operator=(const Future&) = delete;
+
+		~Future() {
+			reset();
+		}
+
+		/*
+			returns false if this handle was default constructed, moved from or get() was already called.
+		*/
+		bool is_valid() const noexcept {
+			return state;
+		}
+
+		/*
+			UB if this handle is not valid.
+		*/
+		bool is_ready() const noexcept {
+			return state->isReady.load(std::memory_order_acquire);
+		}
+
+		/*
+			UB if this handle is not valid.
+		*/
+		void wait() const {
+			state->wait();
+		}
+
+		/*
+			UB if this handle is not valid.
+		*/
+		ResultT get() {
+			state->wait();
+			FutureState<ResultT>* const s = state;
+			state = nullptr;
+			return s->take_Result();
+		}
+
+	private:
+		friend class ThreadPool;
+
+		explicit Future(FutureState<ResultT>* s) noexcept:
+			state(s)
+		{
+
+		}
+
+		void reset() noexcept {
+			if (state){
+				state->release();
+				state = nullptr;
+			}
+		}
+
+		FutureState<ResultT>* state{nullptr};
+	};
+
+private:
+
+	/*
+		hands out fixed size blocks for the shared states of submit(), so that they do not need a heap allocation each.
+		blocks are recycled via a free list and only come back to the heap when the slab dies.
+
+		the slab is reference counted by its owning ThreadPool and every block in use,
+		so that a Future may be destroyed after its ThreadPool.
+	*/
+	struct StateSlab {
+		inline static constexpr std::size_t BLOCK_SIZE = 64;
+		inline static constexpr std::size_t BLOCKS_PER_CHUNK = 256;
+
+		union Block {
+			Block* next;
+			alignas(std::max_align_t) unsigned char storage[BLOCK_SIZE];
+		};
+
+		template<typename T>
+		inline static constexpr bool is_fitting = sizeof(T) <= BLOCK_SIZE && alignof(T) <= alignof(std::max_align_t);
+
+		void* allocate() {
+			++refCnt;
+			guard.lock();
+			if (!freeList){
+				Block* const chunk = new Block[BLOCKS_PER_CHUNK];
+				chunks.emplace_back(chunk);
+				for (std::size_t pos = 0; pos != BLOCKS_PER_CHUNK; ++pos){
+					chunk[pos].next = (pos + 1 == BLOCKS_PER_CHUNK)? nullptr : chunk + pos + 1;
+				}
+				freeList = chunk;
+			}
+			Block* const block = freeList;
+			freeList = block->next;
+			guard.unlock();
+			return block->storage;
+		}
+
+		void deallocate(void* ptr) noexcept {
+			Block* const block = static_cast<Block*>(ptr);
+			guard.lock();
+			block->next = freeList;
+			freeList = block;
+			guard.unlock();
+			release();
+		}
+
+		void release() noexcept {
+			if (--refCnt == 0){
+				delete this;
+			}
+		}
+
+		std::vector<std::unique_ptr<Block[]>> chunks{};
+		Block* freeList{nullptr};
+		std::mutex guard{};
+		std::atomic<std::size_t> refCnt{1};
+	};
+
+	/*
+		shared between a Future and the work that produces its result. 
+		dies as soon as both released it.
+	*/
+	struct FutureStateBase {
+
+		/*
+			see Future::wait()
+		*/
+		void wait() {
+			if (isReady.load(std::memory_order_acquire)){
+				return;
+			}
+
+			if (WorkerThread* const self = WorkerThread::currentWorker){
+				while (!isReady.load(std::memory_order_acquire)){
+					if (!self->threadpool.run_pendingWork(*self)){
+						self->pausingWorkCopy();
+					}
+				}
+			} else {
+				isReady.wait(false, std::memory_order_acquire);
+			}
+		}
+
+		void set_Ready() noexcept {
+			isReady.store(true, std::memory_order_release);
+			isReady.notify_all();
+		}
+
+		std::atomic<bool> isReady{false};
+		std::atomic<uint_fast8_t> refCnt{2}; // Future and Promise
+		StateSlab* slab{nullptr}; // nullptr if the state lives on the heap
+		std::exception_ptr exception{};
+	};
+
+	template<typename ResultT>
+	struct FutureState : FutureStateBase {
+		static_assert(!std::is_reference_v<ResultT>, "ThreadPool::submit() does not support work that returns a reference.");
+
+		using ValueT = std::conditional_t<std::is_void_v<ResultT>, char, ResultT>;
+
+		static FutureState* create(StateSlab& slab) {
+			if constexpr (StateSlab::is_fitting<FutureState>){
+				FutureState* const state = ::new (slab.allocate()) FutureState;
+				state->slab = &slab;
+				return state;
+			} else {
+				return new FutureState;
+			}
+		}
+
+		/*
+			the producing side. releases its share of the state, when it is destroyed.
+			if it is destroyed without running, the Future gets a broken_promise exception instead of waiting forever.
+		*/
+		struct Promise {
+			explicit Promise(FutureState* s) noexcept:
+				state(s)
+			{
+
+			}
+
+			Promise(Promise&& mv) noexcept:
+				state(mv.state)
+			{
+				mv.state = nullptr;
+			}
+
+			~Promise() {
+				if (state){
+					if (!state->isReady.load(std::memory_order_relaxed)){
+						state->exception = std::make_exception_ptr(std::future_error(std::future_errc::broken_promise));
+						state->set_Ready();
+					}
+					state->release();
+				}
+			}
+
+			template<typename FuncT, typename... ArgsT>
+			void run(FuncT& fn, ArgsT&... args) noexcept {
+				try {
+					if constexpr (std::is_void_v<ResultT>){
+						std::invoke(std::move(fn), std::move(args)...);
+					} else {
+						::new (static_cast<void*>(state->value)) ResultT(std::invoke(std::move(fn), std::move(args)...));
+						state->hasValue = true;
+					}
+				} catch (...) {
+					state->exception = std::current_exception();
+				}
+				state->set_Ready();
+			}
+
+			FutureState* state;
+		};
+
+		ResultT take_Result() {
+			struct Releaser {
+				~Releaser() { s->release(); }
+				FutureState* s;
+			} releaser{this};
+
+			if (exception){
+				std::rethrow_exception(exception);
+			}
+			if constexpr (!std::is_void_v<ResultT>){
+				return std::move(*std::launder(reinterpret_cast<ResultT*>(value)));
+			}
+		}
+
+		void release() noexcept {
+			if (--refCnt == 0){
+				if (hasValue){
+					std::launder(reinterpret_cast<ValueT*>(value))->~ValueT();
+				}
+				if (StateSlab* const owner = slab){
+					this->~FutureState();
+					owner->deallocate(this);
+				} else {
+					delete this;
+				}
+			}
+		}
+
+		bool hasValue{false};
+		alignas(ValueT) unsigned char value[sizeof(ValueT)];
+	};
+
+
+	/*
+		lets the workers terminate and waits for them. 
+		the last worker to terminate finishes the remaining work of all queues.
+	*/
+	static void stopFinisher(ThreadPool* poolPtr) {
+		ThreadPool& pool = *poolPtr;
+		
+		{
+			std::lock_guard lock(pool.resizeGuard); // no worker is added or retires from now on
+			pool.requestTerminate = true;
+		}
+		pool.unpause();
+		pool.wake_All();
+
+		for (auto& e : pool.worker){
+			e.join();
+		}
+		pool.isPaused = false;
+		pool.pauseCounter = 0;
+		pool.queueCnt = 0;
+		pool.targetCnt = 0;
+		pool.activeCnt = 0;
+		pool.slotCnt = 0;
+		pool.worker.clear();
+		pool.isStopping = false;
+		pool.isStopping.notify_all();
+	}
+
+	/*
+		a worker pushes normal work into its own queue, any other work goes into the submission queue of the lane of priority.
+		if the submission queue is full and overflow is true, the work goes round-robin into the queues of the workers instead, so that it is never rejected.
+		this is used for work, that the calling thread waits for, like the runners of the parallel algorithms.
+		otherwise the Backpressure policy applies and false is returned if the work was rejected.
+		a worker never waits for space, it keeps the work in its own queue instead.
+	*/
+	bool push_Work(WorkItem&& item, bool overflow = true, Priority priority = Priority::normal) {
+		SubmissionQueue& lane = submission[static_cast<std::size_t>(priority)];
+
+		if (WorkerThread* const self = WorkerThread::current(*this)){
+			if (priority == Priority::normal || !lane.try_push(item)){
+				self->queue.push(std::move(item));
+				wake_One();
+				return true;
+			}
+			std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in WorkerThread::park()
+			wake_One();
+			return true;
+		}
+
+		threadCntT cnt = queueCnt;
+		if (cnt == 0){
+			startupGuard.lock();
+			cnt = queueCnt;
+			if (cnt == 0){
+				startupWL.emplace_back(std::move(item));
+				startupGuard.unlock();
+				return true;
+			}
+			startupGuard.unlock();
+		}
+
+		if (!lane.try_push(item)){
+			if (overflow){
+				worker[submitCursor++ % cnt].queue.push(std::move(item));
+				wake_One();
+				return true;
+			}
+			if (!lane.push(item, backpressure)){
+				return false;
+			}
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in WorkerThread::park()
+		wake_One();
+		return true;
+	}
+
+	/*
+		pushes items[0, cnt) like push_Work() without overflow, with one lock for a worker queue or the startup work,
+		and with as few claims of the submission queue as there is space for.
+		returns how many items were pushed, the others were rejected.
+	*/
+	std::size_t push_Chunk(WorkItem* items, std::size_t cnt, Priority priority) {
+		SubmissionQueue& lane = submission[static_cast<std::size_t>(priority)];
+
+		if (WorkerThread* const self = WorkerThread::current(*this)){
+			std::size_t pushedCnt = 0;
+			if (priority != Priority::normal){
+				std::size_t firstPos = 0;
+				pushedCnt = lane.claim(cnt, firstPos);
+				for (std::size_t pos = 0; pos != pushedCnt; ++pos){
+					lane.fill(firstPos + pos, items[pos]);
+				}
+				std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in WorkerThread::park()
+			}
+			self->queue.push_Range(items + pushedCnt, cnt - pushedCnt); // what does not fit into the lane
+			wake_Some(cnt);
+			return cnt;
+		}
+
+		if (queueCnt == 0){
+			startupGuard.lock();
+			if (queueCnt == 0){
+				for (std::size_t pos = 0; pos != cnt; ++pos){
+					startupWL.emplace_back(std::move(items[pos]));
+				}
+				startupGuard.unlock();
+				return cnt;
+			}
+			startupGuard.unlock();
+		}
+
+		std::size_t pushedCnt = 0;
+		while (pushedCnt != cnt){
+			std::size_t firstPos = 0;
+			std::size_t claimedCnt = lane.claim(cnt - pushedCnt, firstPos);
+			if (claimedCnt != 0){
+				for (std::size_t pos = 0; pos != claimedCnt; ++pos){
+					lane.fill(firstPos + pos, items[pushedCnt + pos]);
+				}
+			} else if (lane.push(items[pushedCnt], backpressure)){
+				claimedCnt = 1;
+			} else {
+				break;
+			}
+			pushedCnt += claimedCnt;
+
+			std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in WorkerThread::park()
+			wake_Some(claimedCnt); // before the next claim, which might block until the woken workers made space
+		}
+		return pushedCnt;
+	}
+
+	/*
+		a parking worker registers in parkedCnt before it checks the queues for the last time.
+		a worker queue is checked under its lock, the submission queue is checked after a fence, 
+		so that either the worker sees the new work or the pusher sees the parked worker.
+	*/
+	void wake_One() const {
+		if (parkedCnt.load(std::memory_order_relaxed) != 0){
+			parkGuard.lock();
+			parkGuard.unlock();
+			parkSignal.notify_one();
+		}
+	}
+
+	/*
+		wakes up to cnt parked workers, see wake_One().
+	*/
+	void wake_Some(std::size_t cnt) const {
+		const threadCntT parked = parkedCnt.load(std::memory_order_relaxed);
+		if (parked != 0 && cnt != 0){
+			parkGuard.lock();
+			parkGuard.unlock();
+			if (cnt >= parked){
+				parkSignal.notify_all();
+			} else {
+				for (std::size_t i = 0; i != cnt; ++i){
+					parkSignal.notify_one();
+				}
+			}
+		}
+	}
+
+	void wake_All() const {
+		parkGuard.lock();
+		parkGuard.unlock();
+		parkSignal.notify_all();
+	}
+
+	/*
+		returns true if any queue holds work. 
+		locks every queue, unless hint is true.
+	*/
+	bool has_Work(bool hint) {
+		for (const auto& lane : submission){
+			if (!lane.is_empty()){
+				return true;
+			}
+		}
+		for (threadCntT id = 0, cnt = slotCnt; id != cnt; ++id){
+			WorkQueue& queue = worker[id].queue;
+			if (hint? (queue.cnt.load(std::memory_order_relaxed) != 0) : !queue.is_empty()){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::size_t get_chunkSize(std::size_t cnt, std::size_t grainSize) const noexcept {
+		if (grainSize != 0){
+			return grainSize;
+		}
+		const std::size_t targetCnt = (static_cast<std::size_t>(get_workerCnt()) + 1) * CHUNKS_PER_THREAD;
+		return (cnt <= targetCnt)? 1 : (cnt + targetCnt - 1) / targetCnt;
+	}
+
+	/*
+		the shared state of one call of for_eachChunk(). lives on the stack of the calling thread.
+	*/
+	template<typename ChunkFuncT>
+	struct ChunkLoop {
+
+		/*
+			claims and executes chunks until there are none left.
+		*/
+		void run() noexcept {
+			for (std::size_t chunk = nextChunk++; chunk < chunkCnt; chunk = nextChunk++){
+				const std::size_t begin = chunk * chunkSize;
+				const std::size_t end = (begin + chunkSize < cnt)? begin + chunkSize : cnt;
+				try {
+					chunkFn(begin, end, chunk);
+				} catch (...) {
+					if (!hasFailed.exchange(true)){
+						exception = std::current_exception();
+					}
+					nextChunk = chunkCnt; // skips the remaining chunks
+				}
+			}
+		}
+
+		ChunkFuncT& chunkFn;
+		const std::size_t cnt, chunkSize, chunkCnt;
+		std::atomic<std::size_t> nextChunk{0};
+		std::atomic<std::size_t> activeRunners{0};
+		std::atomic<bool> hasFailed{false};
+		std::exception_ptr exception{};
+	};
+
+	/*
+		calls chunkFn(begin, end, chunkIndex) for every chunk of chunkSize elements of [0, cnt), see parallel_for().
+		chunkSize has to be at least 1, see get_chunkSize().
+		some workers get a runner, that claims chunks until none are left. the calling thread does the same.
+		returns when all runners finished, because they refer to the loop on this stack.
+	*/
+	template<typename ChunkFuncT>
+	void for_eachChunk(std::size_t cnt, std::size_t chunkSize, ChunkFuncT&& chunkFn) {
+		if (cnt == 0){
+			return;
+		}
+
+		ChunkLoop<std::remove_reference_t<ChunkFuncT>> loop{chunkFn, cnt, chunkSize, (cnt + chunkSize - 1) / chunkSize};
+
+		const std::size_t workerCnt = is_running()? get_workerCnt() : 0;
+		const threadCntT runnerCnt = static_cast<threadCntT>((loop.chunkCnt - 1 < workerCnt)? loop.chunkCnt - 1 : workerCnt);
+		loop.activeRunners = runnerCnt;
+
+		for (threadCntT runner = 0; runner != runnerCnt; ++runner){
+			push_Work(WorkItem([this, &loop](){
+				loop.run();
+				if (--loop.activeRunners == 0){
+					notify_Progress();
+				}
+			}));
+		}
+
+		loop.run();
+
+		help_until([&loop](){ return loop.activeRunners.load() == 0; });
+
+		if (loop.hasFailed){
+			std::rethrow_exception(loop.exception);
+		}
+	}
+
+	/*
+		the calling thread executes pending work until isDone() returns true. if there is no work, it blocks until notify_Progress() is called.
+		whatever makes isDone() return true, has to call notify_Progress() afterwards.
+	*/
+	template<typename PredicateT>
+	void help_until(PredicateT&& isDone) {
+		while (!isDone()){
+			if (!help_Once()){
+				++progressWaiterCnt;
+				const uint_fast32_t epoch = progressEpoch.load();
+				if (!isDone()){
+					progressEpoch.wait(epoch);
+				}
+				--progressWaiterCnt;
+			}
+		}
+	}
+
+	/*
+		wakes every thread that is blocked in help_until(). 
+		only touches members of the ThreadPool, so it may be called after the waited on object died.
+	*/
+	void notify_Progress() const {
+		if (progressWaiterCnt.load() != 0){
+			++progressEpoch;
+			progressEpoch.notify_all();
+		}
+	}
+
+	/*
+		self is nullptr if the calling thread is not a worker of this ThreadPool.
+	*/
+	void execute(WorkItem& item, WorkerThread* self) {
+		if constexpr (IS_COLLECTING_STATS){
+			if (self){
+				execute_measured(item, *self);
+				return;
+			}
+		}
+
+		item();
+		item.reset();
+		if (self){
+			self->finishedCnt.store(self->finishedCnt.load(std::memory_order_relaxed) + 1);
+		} else {
+			++externalFinishedCnt;
+			notify_Progress();
+		}
+	}
+
+	/*
+		execute() with stats. busy time is only measured for the outermost work, because work that runs while other work waits is already part of it.
+	*/
+	void execute_measured(WorkItem& item, WorkerThread& self) {
+		WorkerCounters& c = self.counters;
+		const int_fast64_t begin = get_timeNs();
+		c.record(c.waitHistogram, begin - static_cast<int_fast64_t&>(item.createTime));
+
+		++c.executionDepth;
+		try {
+			item();
+		} catch (...) {
+			--c.executionDepth;
+			throw;
+		}
+		--c.executionDepth;
+		item.reset();
+
+		const int_fast64_t runTime = get_timeNs() - begin;
+		c.record(c.runHistogram, runTime);
+		if (c.executionDepth == 0){
+			WorkerCounters::add(c.busyNs, static_cast<uint_fast64_t>(runTime));
+		}
+		self.finishedCnt.store(self.finishedCnt.load(std::memory_order_relaxed) + 1);
+	}
+
+	/*
+		executes one piece of pending work on behalf of self, which has to be a worker of this ThreadPool.
+		returns false if there was no work.
+	*/
+	bool run_pendingWork(WorkerThread& self) {
+		WorkItem item{};
+		if (take_Work(&self, item)){
+			execute(item, &self);
+			return true;
+		}
+		return false;
+	}
+
+	/*
+		takes the next work for self, or for a thread that is not a worker if self is nullptr, in the order described at Priority.
+		every time a lane is passed over while it holds work, its skip count grows. a lane whose skip count reached AGING_LIMIT is served first.
+	*/
+	bool take_Work(WorkerThread* self, WorkItem& out) {
+		SubmissionQueue& high = submission[static_cast<std::size_t>(Priority::high)];
+		SubmissionQueue& normal = submission[static_cast<std::size_t>(Priority::normal)];
+		SubmissionQueue& low = submission[static_cast<std::size_t>(Priority::low)];
+
+		// counts where a worker took its work from, if stats are collected
+		const auto taken = [self](std::atomic<uint_fast64_t> WorkerCounters::* source){
+			if constexpr (IS_COLLECTING_STATS){
+				if (self){
+					WorkerCounters& c = self->counters;
+					WorkerCounters::add(c.*source, 1);
+				}
+			}
+			return true;
+		};
+
+		if (low.skipCnt.load(std::memory_order_relaxed) >= AGING_LIMIT && low.pop(out)){
+			low.skipCnt.store(0, std::memory_order_relaxed);
+			return taken(&WorkerCounters::submittedCnt);
+		}
+		if (normal.skipCnt.load(std::memory_order_relaxed) >= AGING_LIMIT && normal.pop(out)){
+			normal.skipCnt.store(0, std::memory_order_relaxed);
+			return taken(&WorkerCounters::submittedCnt);
+		}
+
+		if (high.pop(out)){
+			normal.note_Skip();
+			low.note_Skip();
+			return taken(&WorkerCounters::submittedCnt);
+		}
+		std::atomic<uint_fast64_t> WorkerCounters::* source = nullptr;
+		if (self && self->queue.pop(out)){
+			source = &WorkerCounters::localCnt;
+		} else if (normal.pop(out)){
+			source = &WorkerCounters::submittedCnt;
+		} else if (steal_Work(self, out)){
+			source = &WorkerCounters::stolenCnt;
+		}
+		if (source){
+			normal.skipCnt.store(0, std::memory_order_relaxed);
+			low.note_Skip();
+			return taken(source);
+		}
+		if (low.pop(out)){
+			low.skipCnt.store(0, std::memory_order_relaxed);
+			return taken(&WorkerCounters::submittedCnt);
+		}
+		return false;
+	}
+
+	/*
+		inserts a timer, that expires after delayNs and then every periodNs, if that is not 0.
+		wakes a parked worker, if the timer expires before all others.
+	*/
+	Timer add_Timer(int_fast64_t delayNs, int_fast64_t periodNs, voidFunc&& fn) {
+		const int_fast64_t tickNs = TIMER_TICK.count();
+		const uint_fast64_t periodTicks = (periodNs <= 0)? 0 : static_cast<uint_fast64_t>((periodNs + tickNs - 1) / tickNs);
+		const int_fast64_t dueNs = get_timeNs() + ((delayNs < 0)? 0 : delayNs) - timerOriginNs;
+		const uint_fast64_t dueTick = (dueNs <= 0)? 0 : static_cast<uint_fast64_t>((dueNs + tickNs - 1) / tickNs);
+
+		std::unique_lock lock(timerGuard);
+		const int_fast64_t previousNs = nextTimerNs.load(std::memory_order_relaxed);
+		const uint_fast32_t index = timers.insert(std::move(fn), dueTick, periodTicks);
+		const Timer res(this, index, timers.nodes[index].generation);
+		update_nextTimer();
+		const bool isFirst = nextTimerNs.load(std::memory_order_relaxed) < previousNs;
+		lock.unlock();
+
+		if (isFirst){
+			std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in WorkerThread::park()
+			wake_One();
+		}
+		return res;
+	}
+
+	/*
+		timerGuard has to be locked. publishes when the workers have to advance the wheel next.
+	*/
+	void update_nextTimer() noexcept {
+		const uint_fast64_t tick = timers.get_nextEventTick();
+		nextTimerNs.store((tick == TimerWheel::NO_TICK)? NO_DEADLINE : timerOriginNs + static_cast<int_fast64_t>(tick) * TIMER_TICK.count(), std::memory_order_relaxed);
+	}
+
+	bool is_timerDue() const noexcept {
+		const int_fast64_t deadlineNs = nextTimerNs.load(std::memory_order_relaxed);
+		return deadlineNs != NO_DEADLINE && get_timeNs() >= deadlineNs;
+	}
+
+	/*
+		called by a worker, once nextTimerNs passed. advances the wheel to now and pushes the expired work in one chunk.
+		gives up right away, if another worker does it.
+	*/
+	void service_Timers() {
+		std::vector<WorkItem> expired;
+		{
+			std::unique_lock lock(timerGuard, std::try_to_lock);
+			if (!lock.owns_lock()){
+				return;
+			}
+			const int_fast64_t nowNs = get_timeNs() - timerOriginNs;
+			timers.advance((nowNs <= 0)? 0 : static_cast<uint_fast64_t>(nowNs / TIMER_TICK.count()), expired);
+			update_nextTimer();
+		}
+		if (!expired.empty()){
+			push_Chunk(expired.data(), expired.size(), Priority::high);
+		}
+	}
+
+	/*
+		resizeGuard has to be locked, so that no worker retires, no pause starts and no pausing worker counts down in the meantime.
+		a new worker during a pause is counted by that pause, a new worker during a finished pause waits in WorkerThread::work() until unpause().
+	*/
+	threadCntT grow_Locked(threadCntT cnt) {
+		if (queueCnt == 0 || requestTerminate){
+			return 0;
+		}
+		const threadCntT newCnt = (cnt > WORKER_SLOT_CNT - targetCnt)? WORKER_SLOT_CNT : static_cast<threadCntT>(targetCnt + cnt);
+		const threadCntT addedCnt = static_cast<threadCntT>(newCnt - targetCnt);
+
+		for (threadCntT id = targetCnt; id != newCnt; ++id){
+			WorkerThread& w = worker[id];
+			if (w.isActive){
+				continue; // it did not retire yet and stays now
+			}
+			w.join(); // it retired before, and only exits after that
+			w.isActive = true;
+			++activeCnt;
+			++aliveCnt;
+			if (pauseCounter != 0){
+				++pauseCounter;
+			}
+			w.start();
+		}
+
+		targetCnt = newCnt;
+		queueCnt = newCnt;
+		if (slotCnt < newCnt){
+			slotCnt = newCnt;
+		}
+		return addedCnt;
+	}
+
+	/*
+		resizeGuard has to be locked. the retiring workers find out on their own, the parked ones are woken up for it.
+	*/
+	threadCntT shrink_Locked(threadCntT cnt) {
+		if (queueCnt == 0 || requestTerminate){
+			return 0;
+		}
+		const threadCntT newCnt = (cnt >= targetCnt)? 1 : static_cast<threadCntT>(targetCnt - cnt);
+		const threadCntT retiredCnt = static_cast<threadCntT>(targetCnt - newCnt);
+		targetCnt = newCnt;
+		queueCnt = newCnt;
+		wake_All();
+		return retiredCnt;
+	}
+
+	/*
+		called by w, if its id is not smaller than targetCnt. it may not retire while a pause counts on it.
+		returns true, if w retired and has to exit.
+	*/
+	bool retire_Worker(WorkerThread& w) {
+		std::lock_guard lock(resizeGuard);
+		if (w.id < targetCnt || pauseCounter != 0 || requestTerminate){
+			return false;
+		}
+		w.isActive = false;
+		--activeCnt;
+		return true;
+	}
+
+	/*
+		called by a busy worker every AUTOSCALE_INTERVAL work. adds one worker, if too much work is waiting.
+		gives up right away, if someone else is resizing.
+	*/
+	void autoscale_Grow() {
+		std::unique_lock lock(resizeGuard, std::try_to_lock);
+		if (!lock.owns_lock() || !isAutoscaling || targetCnt >= autoscaling.maxCnt || activeCnt != targetCnt){
+			return;
+		}
+		std::size_t depth = 0;
+		for (const auto& lane : submission){
+			depth += lane.get_depth();
+		}
+		for (threadCntT id = 0, cnt = slotCnt; id != cnt; ++id){
+			depth += worker[id].queue.cnt.load(std::memory_order_relaxed);
+		}
+		if (depth > autoscaling.growDepth * targetCnt){
+			grow_Locked(1);
+		}
+	}
+
+	/*
+		called by a worker, that found no work for autoscaling.retireAfter. retires one worker, if there are more than minCnt.
+	*/
+	void autoscale_Shrink() {
+		std::unique_lock lock(resizeGuard, std::try_to_lock);
+		if (!lock.owns_lock() || !isAutoscaling || targetCnt <= autoscaling.minCnt || activeCnt != targetCnt){
+			return;
+		}
+		shrink_Locked(1);
+	}
+
+	/*
+		assigns the cpus and the node of every worker, according to placement.
+		with numaNodes, every worker gets a steal order, that lists the workers of its own node first, each group starting right after itself.
+	*/
+	void place_Workers() {
+		const threadCntT cnt = static_cast<threadCntT>(worker.size());
+
+		if (placement.policy == PlacementPolicy::cpuSets && !placement.cpuSets.empty()){
+			for (threadCntT id = 0; id != cnt; ++id){
+				worker[id].cpus = placement.cpuSets[id % placement.cpuSets.size()];
+			}
+		} else if (placement.policy == PlacementPolicy::numaNodes){
+			const std::vector<std::vector<unsigned>> nodes = get_numaNodes();
+			for (threadCntT id = 0; id != cnt; ++id){
+				worker[id].node = static_cast<unsigned>(id % nodes.size());
+				worker[id].cpus = nodes[worker[id].node];
+			}
+			for (threadCntT id = 0; id != cnt; ++id){
+				std::vector<threadCntT>& order = worker[id].stealOrder;
+				for (int sameNode = 1; sameNode >= 0; --sameNode){
+					for (threadCntT offset = 1; offset != cnt; ++offset){
+						const threadCntT victim = static_cast<threadCntT>((id + offset) % cnt);
+						if ((worker[victim].node == worker[id].node) == static_cast<bool>(sameNode)){
+							order.push_back(victim);
+						}
+					}
+				}
+				order.push_back(id); // its own queue, in case it steals for a waiting thread
+			}
+		}
+	}
+
+	/*
+		takes work from the queues of all other workers, starting right after thief, or from all workers if thief is nullptr.
+		this includes the queues of retired workers, which might still hold work.
+		a worker only steals after its own queue ran empty.
+	*/
+	bool steal_Work(const WorkerThread* thief, WorkItem& out) {
+		const threadCntT cnt = slotCnt;
+
+		if (thief && !thief->stealOrder.empty()){
+			for (threadCntT victim : thief->stealOrder){
+				if (victim < cnt && worker[victim].queue.steal(out)){
+					return true;
+				}
+			}
+			return false;
+		}
+
+		const threadCntT first = thief? thief->id : 0;
+
+		for (threadCntT offset = 1; offset <= cnt; ++offset){
+			if (worker[(first + offset) % cnt].queue.steal(out)){
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	/*
+		a double ended queue that belongs to exactly one worker.
+		the owner takes work from the front, thieves take work from the back, so that both rarely want the same element.
+		guarded by its own lock, so that workers only contend if one of them is stealing.
+
+		the work is stored in a ring buffer that only ever grows, so that a queue in use does not allocate.
+	*/
+	struct WorkQueue {
+
+		WorkQueue() = default;
+
+		WorkQueue(WorkQueue&& mv):
+			ring(std::move(mv.ring)),
+			head(mv.head),
+			capacity(mv.capacity),
+			cnt(mv.cnt.load(std::memory_order_relaxed)),
+			pushCnt(mv.pushCnt.load(std::memory_order_relaxed))
+		{
+			mv.head = mv.capacity = 0;
+			mv.cnt.store(0, std::memory_order_relaxed);
+		}
+
+		WorkQueue& operator=(WorkQueue&& mv) {
+			ring = std::move(mv.ring);
+			head = mv.head;
+			cnt.store(mv.cnt.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			pushCnt.store(mv.pushCnt.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			capacity = mv.capacity;
+			mv.head = mv.capacity = 0;
+			mv.cnt.store(0, std::memory_order_relaxed);
+			return *this;
+		}
+
+		void push(WorkItem&& item) {
+			guard.lock();
+			const std::size_t n = cnt.load(std::memory_order_relaxed);
+			if (n == capacity){
+				grow();
+			}
+			ring[(head + n) & (capacity - 1)] = std::move(item);
+			cnt.store(n + 1, std::memory_order_relaxed);
+			pushCnt.store(pushCnt.load(std::memory_order_relaxed) + 1);
+			guard.unlock();
+		}
+
+		/*
+			moves items[0, cnt) into the queue and grows at most once.
+		*/
+		void push_Range(WorkItem* items, std::size_t itemCnt) {
+			guard.lock();
+			const std::size_t n = cnt.load(std::memory_order_relaxed);
+			if (n + itemCnt > capacity){
+				grow(n + itemCnt);
+			}
+			for (std::size_t pos = 0; pos != itemCnt; ++pos){
+				ring[(head + n + pos) & (capacity - 1)] = std::move(items[pos]);
+			}
+			cnt.store(n + itemCnt, std::memory_order_relaxed);
+			pushCnt.store(pushCnt.load(std::memory_order_relaxed) + itemCnt);
+			guard.unlock();
+		}
+
+		bool pop(WorkItem& out) {
+			guard.lock();
+			const std::size_t n = cnt.load(std::memory_order_relaxed);
+			if (n == 0){
+				guard.unlock();
+				return false;
+			}
+			out = std::move(ring[head]);
+			head = (head + 1) & (capacity - 1);
+			cnt.store(n - 1, std::memory_order_relaxed);
+			guard.unlock();
+			return true;
+		}
+
+		bool steal(WorkItem& out) {
+			guard.lock();
+			const std::size_t n = cnt.load(std::memory_order_relaxed);
+			if (n == 0){
+				guard.unlock();
+				return false;
+			}
+			out = std::move(ring[(head + n - 1) & (capacity - 1)]);
+			cnt.store(n - 1, std::memory_order_relaxed);
+			guard.unlock();
+			return true;
+		}
+
+		/*
+			moves the work into a new ring, that is allocated and first touched by the calling thread.
+		*/
+		void relocate() {
+			guard.lock();
+			if (capacity != 0){
+				std::unique_ptr<WorkItem[]> newRing(new WorkItem[capacity]);
+				for (std::size_t pos = 0, n = cnt.load(std::memory_order_relaxed); pos != n; ++pos){
+					newRing[pos] = std::move(ring[(head + pos) & (capacity - 1)]);
+				}
+				ring = std::move(newRing);
+				head = 0;
+			} else {
+				grow();
+			}
+			guard.unlock();
+		}
+
+		bool is_empty() {
+			guard.lock();
+			const bool res = (cnt.load(std::memory_order_relaxed) == 0);
+			guard.unlock();
+			return res;
+		}
+
+		/*
+			capacity is always a power of 2
+		*/
+		void grow(std::size_t minCapacity = 0) {
+			std::size_t newCapacity = (capacity == 0)? 64 : capacity * 2;
+			while (newCapacity < minCapacity){
+				newCapacity *= 2;
+			}
+			std::unique_ptr<WorkItem[]> newRing(new WorkItem[newCapacity]);
+
+			for (std::size_t pos = 0, n = cnt.load(std::memory_order_relaxed); pos != n; ++pos){
+				newRing[pos] = std::move(ring[(head + pos) & (capacity - 1)]);
+			}
+			ring = std::move(newRing);
+			head = 0;
+			capacity = newCapacity;
+		}
+
+		std::unique_ptr<WorkItem[]> ring{};
+		std::size_t head{0}, capacity{0};
+		std::atomic<std::size_t> cnt{0}; // only changed under guard, may be read without it as a hint
+		std::atomic<uint_fast64_t> pushCnt{0}; // only changed under guard
+		std::mutex guard{};
+	};
+
+	/*
+		a bounded ring buffer of work, that any number of threads push into and pop from without a lock.
+		every cell carries a sequence number, that tells whether the cell is free for the push of a position or holds the work of a position.
+		a push claims its position with one CAS on pushPos, a pop with one CAS on popPos, and both live on their own cache line.
+
+		pushPos only ever grows and is claimed before the work is visible, so it doubles as the count of pushed work.
+	*/
+	struct SubmissionQueue {
+
+		explicit SubmissionQueue(std::size_t minCapacity) {
+			while (capacity < minCapacity){
+				capacity *= 2;
+			}
+			cells.reset(new Cell[capacity]);
+			for (std::size_t pos = 0; pos != capacity; ++pos){
+				cells[pos].sequence.store(pos, std::memory_order_relaxed);
+			}
+		}
+
+		/*
+			moves item into the queue, unless it is full.
+		*/
+		bool try_push(WorkItem& item) {
+			std::size_t pos = pushPos.load(std::memory_order_relaxed);
+			while (true){
+				Cell& cell = cells[pos & (capacity - 1)];
+				const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+				const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - pos);
+
+				if (diff == 0){
+					if (pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+						cell.item = std::move(item);
+						cell.sequence.store(pos + 1, std::memory_order_release);
+						note_Depth(pos + 1);
+						return true;
+					}
+				} else if (diff < 0){
+					return false;
+				} else {
+					pos = pushPos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/*
+			claims up to maxCnt consecutive positions with one CAS, the first one is stored in pos.
+			returns how many positions were claimed, 0 if the queue is full.
+			every claimed position has to be filled with fill().
+		*/
+		std::size_t claim(std::size_t maxCnt, std::size_t& pos) {
+			pos = pushPos.load(std::memory_order_relaxed);
+			while (true){
+				const std::ptrdiff_t usedCnt = static_cast<std::ptrdiff_t>(pos - popPos.load(std::memory_order_relaxed));
+				if (usedCnt >= static_cast<std::ptrdiff_t>(capacity)){
+					return 0;
+				}
+				const std::size_t freeCnt = (usedCnt < 0)? capacity : capacity - static_cast<std::size_t>(usedCnt);
+				const std::size_t claimedCnt = (maxCnt < freeCnt)? maxCnt : freeCnt;
+				if (pushPos.compare_exchange_weak(pos, pos + claimedCnt, std::memory_order_relaxed)){
+					note_Depth(pos + claimedCnt);
+					return claimedCnt;
+				}
+			}
+		}
+
+		/*
+			moves item into a position that was claimed with claim().
+			the pop of the previous round of the cell was already claimed, but might not be done yet.
+		*/
+		void fill(std::size_t pos, WorkItem& item) {
+			Cell& cell = cells[pos & (capacity - 1)];
+			while (cell.sequence.load(std::memory_order_acquire) != pos){
+				std::this_thread::yield();
+			}
+			cell.item = std::move(item);
+			cell.sequence.store(pos + 1, std::memory_order_release);
+		}
+
+		/*
+			moves item into the queue and applies policy while it is full.
+			returns false if the work was rejected.
+		*/
+		bool push(WorkItem& item, Backpressure policy) {
+			while (!try_push(item)){
+				if (policy == Backpressure::reject){
+					return false;
+				}
+				if (policy == Backpressure::spin){
+					std::this_thread::yield();
+					continue;
+				}
+
+				++blockedCnt;
+				std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in pop()
+				const uint_fast32_t epoch = popEpoch.load();
+				const bool isPushed = try_push(item);
+				if (!isPushed){
+					popEpoch.wait(epoch);
+				}
+				--blockedCnt;
+				if (isPushed){
+					break;
+				}
+			}
+			return true;
+		}
+
+		bool pop(WorkItem& out) {
+			std::size_t pos = popPos.load(std::memory_order_relaxed);
+			while (true){
+				Cell& cell = cells[pos & (capacity - 1)];
+				const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+				const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+
+				if (diff == 0){
+					if (popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+						out = std::move(cell.item);
+						cell.sequence.store(pos + capacity, std::memory_order_release);
+						
+						std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in push()
+						if (blockedCnt.load(std::memory_order_relaxed) != 0){
+							++popEpoch;
+							popEpoch.notify_all();
+						}
+						return true;
+					}
+				} else if (diff < 0){
+					return false;
+				} else {
+					pos = popPos.load(std::memory_order_relaxed);
+				}
+			}
+		}
 
-	std::mutex swapGuard{};
+		/*
+			may return false for a moment after the last work was taken, but never returns true while work is visible.
+		*/
+		bool is_empty() const noexcept {
+			const std::size_t pos = popPos.load();
+			return static_cast<std::ptrdiff_t>(cells[pos & (capacity - 1)].sequence.load() - (pos + 1)) < 0;
+		}
+
+		uint_fast64_t get_pushCnt() const noexcept {
+			return pushPos.load();
+		}
+
+		std::size_t get_depth() const noexcept {
+			const std::size_t popped = popPos.load(std::memory_order_relaxed);
+			const std::size_t pushed = pushPos.load(std::memory_order_relaxed);
+			return (pushed > popped)? pushed - popped : 0;
+		}
+
+		/*
+			raises peakDepth to the depth, that the queue had right after the push that ended at endPos.
+		*/
+		void note_Depth(std::size_t endPos) noexcept {
+			const std::ptrdiff_t depth = static_cast<std::ptrdiff_t>(endPos - popPos.load(std::memory_order_relaxed));
+			std::size_t peak = peakDepth.load(std::memory_order_relaxed);
+			while (depth > static_cast<std::ptrdiff_t>(peak) && !peakDepth.compare_exchange_weak(peak, static_cast<std::size_t>(depth), std::memory_order_relaxed)){
+
+			}
+		}
+
+		/*
+			counts that this queue was passed over, if it holds work.
+		*/
+		void note_Skip() noexcept {
+			if (get_depth() != 0){
+				skipCnt.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		struct Cell {
+			std::atomic<std::size_t> sequence{0};
+			WorkItem item{};
+		};
+
+		std::unique_ptr<Cell[]> cells{};
+		std::size_t capacity{1};
+		alignas(64) std::atomic<std::size_t> pushPos{0};
+		std::atomic<std::size_t> peakDepth{0};
+		alignas(64) std::atomic<std::size_t> popPos{0};
+		std::atomic<uint_fast32_t> skipCnt{0};
+		alignas(64) std::atomic<uint_fast32_t> popEpoch{0};
+		std::atomic<threadCntT> blockedCnt{0};
+	};
+
+	/*
+		a hierarchical timer wheel of LEVEL_CNT levels with 64 slots each. a slot of level l spans 64^l ticks.
+		a timer is kept in the lowest level, that reaches its tick, and moves down one level whenever the wheel reaches its slot,
+		until it expires in level 0. insert() and cancel() are O(1), advance() only visits slots, that hold timers.
+
+		the timers live in one vector and link to each other by index, so that a Timer only needs an index and a generation.
+		the generation changes whenever a timer is freed, so that an old handle does not cancel a new timer.
+	*/
+	struct TimerWheel {
+		inline static constexpr std::size_t LEVEL_CNT = 6;
+		inline static constexpr std::size_t SLOT_BITS = 6;
+		inline static constexpr std::size_t SLOT_CNT = std::size_t(1) << SLOT_BITS;
+		inline static constexpr uint_fast64_t MAX_DELTA = (uint_fast64_t(1) << (SLOT_BITS * LEVEL_CNT)) - 1;
+		inline static constexpr uint_fast32_t NO_TIMER = static_cast<uint_fast32_t>(-1);
+		inline static constexpr uint_fast64_t NO_TICK = static_cast<uint_fast64_t>(-1);
+
+		struct Node {
+			voidFunc fn{};
+			uint_fast64_t dueTick{0};
+			uint_fast64_t periodTicks{0};
+			uint_fast32_t generation{0};
+			uint_fast32_t prev{NO_TIMER};
+			uint_fast32_t next{NO_TIMER};
+			uint_fast16_t slot{0}; // level * SLOT_CNT + index
+			bool isPending{false};
+		};
+
+		TimerWheel() {
+			std::fill(std::begin(slots), std::end(slots), NO_TIMER);
+		}
+
+		/*
+			a dueTick, that already passed, expires with the next tick.
+		*/
+		uint_fast32_t insert(voidFunc&& fn, uint_fast64_t dueTick, uint_fast64_t periodTicks) {
+			uint_fast32_t index = freeList;
+			if (index == NO_TIMER){
+				index = static_cast<uint_fast32_t>(nodes.size());
+				nodes.emplace_back();
+			} else {
+				freeList = nodes[index].next;
+			}
+			Node& node = nodes[index];
+			node.fn = std::move(fn);
+			node.dueTick = (dueTick <= currentTick)? currentTick + 1 : dueTick;
+			node.periodTicks = periodTicks;
+			node.isPending = true;
+			link(index);
+			++pendingCnt;
+			return index;
+		}
+
+		bool cancel(uint_fast32_t index, uint_fast32_t generation) {
+			if (index >= nodes.size() || nodes[index].generation != generation || !nodes[index].isPending){
+				return false;
+			}
+			unlink(index);
+			release(index);
+			return true;
+		}
+
+		/*
+			moves the wheel forward to tick and appends the work of every timer, that expired on the way, to expired.
+			a periodic timer is linked again one period later, runs that lie in the past by now are skipped.
+		*/
+		void advance(uint_fast64_t tick, std::vector<WorkItem>& expired) {
+			while (currentTick < tick){
+				const uint_fast64_t eventTick = get_nextEventTick();
+				if (eventTick > tick){
+					currentTick = tick;
+					return;
+				}
+				currentTick = eventTick;
+
+				for (std::size_t level = 1; level != LEVEL_CNT; ++level){ // lower levels first, see cascade()
+					if ((currentTick & ((uint_fast64_t(1) << (SLOT_BITS * level)) - 1)) != 0){
+						break;
+					}
+					cascade(level * SLOT_CNT + ((currentTick >> (SLOT_BITS * level)) & (SLOT_CNT - 1)));
+				}
+
+				const std::size_t slot = currentTick & (SLOT_CNT - 1);
+				uint_fast32_t index = slots[slot];
+				slots[slot] = NO_TIMER;
+				occupied[0] &= ~(uint_fast64_t(1) << slot);
+				while (index != NO_TIMER){
+					Node& node = nodes[index];
+					const uint_fast32_t next = node.next;
+					if (node.periodTicks == 0){
+						expired.emplace_back(std::move(node.fn));
+						release(index);
+					} else {
+						expired.emplace_back(node.fn);
+						const uint_fast64_t missedCnt = (tick - currentTick) / node.periodTicks;
+						node.dueTick = currentTick + (missedCnt + 1) * node.periodTicks;
+						link(index);
+					}
+					index = next;
+				}
+			}
+		}
+
+		/*
+			the next tick, at which advance() has to look at a slot. NO_TICK if there are no timers.
+			for every level, the occupied slots are rotated, so that the first one after the current slot is the lowest bit.
+		*/
+		uint_fast64_t get_nextEventTick() const noexcept {
+			uint_fast64_t res = NO_TICK;
+			for (std::size_t level = 0; level != LEVEL_CNT; ++level){
+				if (occupied[level] == 0){
+					continue;
+				}
+				const std::size_t shift = SLOT_BITS * level;
+				const uint_fast64_t levelTick = currentTick >> shift;
+				const int current = static_cast<int>(levelTick & (SLOT_CNT - 1));
+				const uint_fast64_t ahead = static_cast<uint_fast64_t>(std::countr_zero(std::rotr(static_cast<uint64_t>(occupied[level]), current + 1))) + 1;
+				const uint_fast64_t eventTick = (levelTick + ahead) << shift;
+				if (eventTick < res){
+					res = eventTick;
+				}
+			}
+			return res;
+		}
+
+		std::vector<Node> nodes{};
+		uint_fast32_t freeList{NO_TIMER};
+		uint_fast32_t slots[LEVEL_CNT * SLOT_CNT];
+		uint_fast64_t occupied[LEVEL_CNT]{};
+		uint_fast64_t currentTick{0};
+		std::size_t pendingCnt{0};
+
+	private:
+
+		/*
+			a timer in level l is due in less than 64^(l+1) ticks. 
+			if the wheel is at the first tick of a slot of level l, the timers in that slot are due in less than 64^l ticks,
+			so cascade() links them into a lower level, that was already cascaded in this tick.
+		*/
+		void link(uint_fast32_t index) {
+			Node& node = nodes[index];
+			uint_fast64_t delta = node.dueTick - currentTick;
+			uint_fast64_t dueTick = node.dueTick;
+			if (delta > MAX_DELTA){ // parks it in the highest level, from where it is linked again later
+				delta = MAX_DELTA;
+				dueTick = currentTick + MAX_DELTA;
+			}
+			std::size_t level = 0;
+			while (level + 1 != LEVEL_CNT && (delta >> (SLOT_BITS * (level + 1))) != 0){
+				++level;
+			}
+			const std::size_t slotIndex = (dueTick >> (SLOT_BITS * level)) & (SLOT_CNT - 1);
+			node.slot = static_cast<uint_fast16_t>(level * SLOT_CNT + slotIndex);
+			node.prev = NO_TIMER;
+			node.next = slots[node.slot];
+			if (node.next != NO_TIMER){
+				nodes[node.next].prev = index;
+			}
+			slots[node.slot] = index;
+			occupied[level] |= uint_fast64_t(1) << slotIndex;
+		}
+
+		void unlink(uint_fast32_t index) {
+			Node& node = nodes[index];
+			if (node.prev != NO_TIMER){
+				nodes[node.prev].next = node.next;
+			} else {
+				slots[node.slot] = node.next;
+				if (node.next == NO_TIMER){
+					occupied[node.slot / SLOT_CNT] &= ~(uint_fast64_t(1) << (node.slot % SLOT_CNT));
+				}
+			}
+			if (node.next != NO_TIMER){
+				nodes[node.next].prev = node.prev;
+			}
+		}
+
+		void cascade(std::size_t slot) {
+			uint_fast32_t index = slots[slot];
+			slots[slot] = NO_TIMER;
+			occupied[slot / SLOT_CNT] &= ~(uint_fast64_t(1) << (slot % SLOT_CNT));
+			while (index != NO_TIMER){
+				const uint_fast32_t next = nodes[index].next;
+				link(index);
+				index = next;
+			}
+		}
+
+		void release(uint_fast32_t index) {
+			Node& node = nodes[index];
+			node.fn = nullptr;
+			node.isPending = false;
+			++node.generation;
+			node.next = freeList;
+			freeList = index;
+			--pendingCnt;
+		}
+	};
+
+	/*
+		the counters behind WorkerStats. only the owning worker writes them, with a relaxed load and store instead of a read-modify-write,
+		so that they cost no more than plain integers. any thread may read them.
+	*/
+	struct WorkerCounters {
+
+		static void add(std::atomic<uint_fast64_t>& counter, uint_fast64_t value) noexcept {
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		void record(std::atomic<uint_fast64_t> (&histogram)[HISTOGRAM_SIZE], int_fast64_t durationNs) noexcept {
+			const std::size_t bucket = (durationNs <= 0)? 0 : static_cast<std::size_t>(std::bit_width(static_cast<uint_fast64_t>(durationNs)));
+			add(histogram[(bucket < HISTOGRAM_SIZE)? bucket : HISTOGRAM_SIZE - 1], 1);
+		}
+
+		std::atomic<uint_fast64_t> localCnt{0};
+		std::atomic<uint_fast64_t> submittedCnt{0};
+		std::atomic<uint_fast64_t> stolenCnt{0};
+		std::atomic<uint_fast64_t> busyNs{0};
+		std::atomic<uint_fast64_t> idleNs{0};
+		std::atomic<uint_fast64_t> pausedNs{0};
+		std::atomic<uint_fast64_t> waitHistogram[HISTOGRAM_SIZE]{};
+		std::atomic<uint_fast64_t> runHistogram[HISTOGRAM_SIZE]{};
+		uint_fast32_t executionDepth{0}; // only used by the owning worker
+	};
+
+	struct WorkerThread {
+
+		template<typename voidFuncT>
+		WorkerThread(
+			ThreadPool& arg_threadpool,
+			threadCntT arg_id,
+			std::thread&& arg_executionThread, 
+			voidFuncT&& arg_pausingWorkCopy
+		):
+			threadpool(arg_threadpool),
+			id(arg_id),
+			executionThread(std::move(arg_executionThread)),
+			pausingWorkCopy(std::forward<voidFuncT>(arg_pausingWorkCopy))
+		{
+
+		}
+
+		WorkerThread(ThreadPool& pool, threadCntT arg_id): WorkerThread(pool, arg_id, std::thread{}, pool.pausingWork)
+		{
+
+		}
+
+		WorkerThread(const WorkerThread& cpy): WorkerThread(cpy.threadpool, cpy.id, std::thread{}, cpy.pausingWorkCopy)
+		{
+
+		}
+
+		WorkerThread(WorkerThread&& mv): WorkerThread(mv.threadpool, mv.id, std::move(mv.executionThread), std::move(mv.pausingWorkCopy))
+		{
+			queue = std::move(mv.queue);
+			cpus = std::move(mv.cpus);
+			stealOrder = std::move(mv.stealOrder);
+			node = mv.node;
+		}
+
+		~WorkerThread() {
+			join();
+		}
+
+		void join() {
+			if (executionThread.joinable()){ 
+				executionThread.join();
+			}
+		}
+
+		/*
+
+		*/
+		void start() {
+			executionThread = std::move(std::thread(work, this));
+			
+		}
+
+		inline void stop() {
+			threadpool.stop();
+		}
+
+		inline void pause() {
+			threadpool.pause();
+		}
+
+		inline void unpause() {
+			threadpool.unpause();
+		}
+
+		/*
+			needs to be paused, else UB
+		*//*
+		template<typename voidFuncT>
+		void set_pausingWork(voidFuncT&& fn = ThreadPool::pausingWork_default) {
+			pausingWorkCopy = std::forward<voidFuncT>(fn);
+		}
+*/
+		/*
+
+		*/
+		static void work(WorkerThread* worker) {
+			WorkerThread& wref = *worker;
+			ThreadPool& pool = wref.threadpool;
+			WorkItem workValue{};
+
+			currentWorker = worker;
+			wref.apply_Placement();
+			if (pool.idleStrategy == IdleStrategy::parking){ // it was added by grow() to a paused pool
+				pool.isPaused.wait(true);
+			} else {
+				while (pool.isPaused && !pool.requestTerminate){
+					wref.pausingWorkCopy();
+				}
+			}
+
+			bool isRetired = false;
+			uint_fast32_t executedCnt = 0;
+			int_fast64_t idleSince = 0;
+
+			while (!pool.requestTerminate && !isRetired){
+				while (pool.pauseCounter == 0 && !pool.requestTerminate){
+
+					if (wref.id >= pool.targetCnt && pool.retire_Worker(wref)){
+						isRetired = true;
+						break;
+					}
+
+					if (pool.is_timerDue()){
+						pool.service_Timers();
+					}
+
+					if (pool.take_Work(worker, workValue)){
+						pool.execute(workValue, &wref);
+						idleSince = 0;
+						if (++executedCnt == AUTOSCALE_INTERVAL){
+							executedCnt = 0;
+							if (pool.isAutoscaling){
+								pool.autoscale_Grow();
+							}
+						}
+						continue;
+					}
+
+					pool.notify_Progress(); // this worker ran out of work, which might make the pool idle
+					const int_fast64_t idleBegin = IS_COLLECTING_STATS? get_timeNs() : 0;
+					if (pool.idleStrategy == IdleStrategy::parking){
+						wref.park();
+					} else {
+						wref.pausingWorkCopy();
+					}
+					if constexpr (IS_COLLECTING_STATS){
+						WorkerCounters& c = wref.counters;
+						WorkerCounters::add(c.idleNs, static_cast<uint_fast64_t>(get_timeNs() - idleBegin));
+					}
+					if (pool.isAutoscaling){
+						const int_fast64_t now = get_timeNs();
+						if (idleSince == 0){
+							idleSince = now;
+						} else if (now - idleSince >= pool.retireAfterNs){
+							idleSince = now;
+							pool.autoscale_Shrink();
+						}
+					}
+					
+				}
+
+				if (pool.requestTerminate || isRetired){
+					break;
+				}
+
+				const int_fast64_t pauseBegin = IS_COLLECTING_STATS? get_timeNs() : 0;
+
+				bool isLast = false;
+				uint_fast32_t epoch = 0;
+				{
+					std::lock_guard lock(pool.resizeGuard); // so that grow() and retire_Worker() see whether a pause is going on
+					epoch = pool.pauseEpoch;
+					isLast = (--pool.pauseCounter == 0);
+					if (isLast){
+						pool.isPaused = true;
+					}
+				}
+				if (isLast){
+					pool.isPaused.notify_all();
+				} else {
+					// a pause, that started after an unpause() in the meantime, has to be counted down again
+					while (pool.pauseCounter != 0 && pool.pauseEpoch == epoch && !pool.requestTerminate){
+						wref.pausingWorkCopy();
+					}
+				}
+
+				if (pool.idleStrategy == IdleStrategy::parking){
+					pool.isPaused.wait(true);
+				} else {
+					while (pool.isPaused && !pool.requestTerminate){
+						wref.pausingWorkCopy();
+					}
+				}
+				if constexpr (IS_COLLECTING_STATS){
+					WorkerCounters& c = wref.counters;
+					WorkerCounters::add(c.pausedNs, static_cast<uint_fast64_t>(get_timeNs() - pauseBegin));
+				}
+				
+
+			}
+
+			if (isRetired){ // the others take over the work, that is left in its queue
+				pool.wake_Some(wref.queue.cnt.load(std::memory_order_relaxed));
+				pool.notify_Progress(); // its last work might have made the pool idle
+			}
+
+			if (--pool.aliveCnt == 0){ // the last thread finishes remaining work of all queues, including work that is added by that remaining work
+				while (pool.take_Work(worker, workValue)){
+					workValue();
+				}
+				workValue.reset();
+			} 
+
+			currentWorker = nullptr;
+		}
+
+		/*
+			spins while looking for work, then blocks until there might be work or the pool wants the worker to pause or terminate.
+			the spin budget grows whenever spinning found work and shrinks whenever the worker had to block.
+		*/
+		void park() {
+			ThreadPool& pool = threadpool;
+
+			for (uint_fast32_t spin = 0; spin != spinBudget; ++spin){
+				std::this_thread::yield();
+				if (pool.has_Work(true) || pool.pauseCounter != 0 || pool.requestTerminate || id >= pool.targetCnt || pool.is_timerDue()){
+					spinBudget = (spinBudget * 2 > PARKING_SPIN_MAX)? PARKING_SPIN_MAX : spinBudget * 2;
+					return;
+				}
+			}
+			spinBudget = (spinBudget / 2 < PARKING_SPIN_MIN)? PARKING_SPIN_MIN : spinBudget / 2;
+
+			std::unique_lock lock(pool.parkGuard);
+			++pool.parkedCnt;
+			std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in push_Work()
+			while (!pool.has_Work(false) && pool.pauseCounter == 0 && !pool.requestTerminate && id < pool.targetCnt && !pool.is_timerDue()){
+				int_fast64_t deadlineNs = pool.nextTimerNs.load(std::memory_order_relaxed);
+				if (pool.isAutoscaling){ // wakes up to count as idle
+					deadlineNs = std::min(deadlineNs, get_timeNs() + pool.retireAfterNs.load());
+				}
+				if (deadlineNs == NO_DEADLINE){
+					pool.parkSignal.wait(lock);
+				} else if (pool.parkSignal.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadlineNs))) == std::cv_status::timeout){
+					break;
+				}
+			}
+			--pool.parkedCnt;
+		}
+
+		/*
+			pins the calling thread, which has to be this worker, to its cpus.
+			then the queue is moved into memory, that this thread touches first, and the user gets a chance to do the same.
+		*/
+		void apply_Placement() {
+			const Placement& placement = threadpool.placement;
+			if (placement.policy == PlacementPolicy::none){
+				return;
+			}
+
+#ifdef __linux__
+			if (!cpus.empty()){
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				for (unsigned cpu : cpus){
+					if (cpu < CPU_SETSIZE){
+						CPU_SET(cpu, &set);
+					}
+				}
+				pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set); // best effort
+			}
+#endif
+
+			queue.relocate();
+			if (placement.onWorkerStart){
+				placement.onWorkerStart(id, node);
+			}
+		}
+
+		/*
+			returns the worker that is executing the calling thread, if it belongs to pool.
+		*/
+		static WorkerThread* current(const ThreadPool& pool) noexcept {
+			return (currentWorker && &currentWorker->threadpool == &pool)? currentWorker : nullptr;
+		}
+
+		bool operator==(const WorkerThread& rhs) const {
+			return this == &rhs;
+		}
+		inline bool operator!=(const WorkerThread& rhs) const {
+			return !(*this == rhs);
+		}
+		
+		bool operator==(const std::thread& rhs) const {
+			return executionThread.get_id() == rhs.get_id();
+		}
+		inline bool operator!=(const std::thread& rhs) const {
+			return !(*this == rhs);
+		}
+
+		ThreadPool& threadpool;
+		threadCntT id;
+		std::thread executionThread;
+		voidFunc pausingWorkCopy;
+		WorkQueue queue{};
+		uint_fast32_t spinBudget{PARKING_SPIN_MIN};
+		std::vector<unsigned> cpus{};
+		std::vector<threadCntT> stealOrder{};
+		unsigned node{0};
+		bool isActive{false}; // guarded by resizeGuard, true from grow() or start() until the worker retires or exits
+		std::atomic<uint_fast64_t> finishedCnt{0}; // only changed by this worker
+		Optional_Member<WorkerCounters, IS_COLLECTING_STATS> counters{};
+
+		inline static thread_local WorkerThread* currentWorker{nullptr};
+	};
+
+	std::vector<WorkerThread> worker{};
+
+	std::vector<WorkItem> startupWL{};
+	std::mutex startupGuard{};
+	std::atomic<threadCntT> queueCnt{0};
+	std::atomic<threadCntT> aliveCnt{0};
+	std::atomic<threadCntT> targetCnt{0}; // workers with a smaller id stay, the others retire
+	std::atomic<threadCntT> activeCnt{0}; // workers that did not retire yet, guarded by resizeGuard
+	std::atomic<threadCntT> slotCnt{0}; // slots that had a worker since start(), their queues may hold work
+	mutable std::mutex resizeGuard{};
+
+	Autoscaling autoscaling{}; // guarded by resizeGuard
+	std::atomic<bool> isAutoscaling{false};
+	std::atomic<int_fast64_t> retireAfterNs{0};
+	std::atomic<threadCntT> submitCursor{0};
+
+	SubmissionQueue submission[PRIORITY_CNT];
+	Backpressure backpressure;
+
+	voidFunc pausingWork {pausingWork_default};
+	IdleStrategy idleStrategy{IdleStrategy::pausingWork};
+	Placement placement{};
+
+	inline static constexpr uint_fast32_t PARKING_SPIN_MIN = 16;
+	inline static constexpr uint_fast32_t PARKING_SPIN_MAX = 1024;
+
+	mutable std::mutex parkGuard{};
+	mutable std::condition_variable parkSignal{};
+	std::atomic<threadCntT> parkedCnt{0};
+
+	inline static constexpr int_fast64_t NO_DEADLINE = INT_FAST64_MAX;
+
+	TimerWheel timers{}; // guarded by timerGuard
+	mutable std::mutex timerGuard{};
+	std::atomic<int_fast64_t> nextTimerNs{NO_DEADLINE};
+	const int_fast64_t timerOriginNs{get_timeNs()};
+
+	std::atomic<uint_fast64_t> externalFinishedCnt{0};
+	mutable std::atomic<uint_fast32_t> progressEpoch{0};
+	std::atomic<threadCntT> progressWaiterCnt{0};
+
+	mutable std::mutex stopGuard{};
+	mutable std::thread finisherThread{};
 
 	mutable std::atomic<uint_fast32_t> pauseCounter{0};
+	mutable std::atomic<uint_fast32_t> pauseEpoch{0};
 	mutable std::atomic<bool> isPaused{false};
 	std::atomic<bool> requestTerminate{false};
+	std::atomic<bool> isStopping{false};
+
+	StateSlab* stateSlab;
 
 };
 
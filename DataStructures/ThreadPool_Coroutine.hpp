@@ -0,0 +1,500 @@
+#ifndef THREADPOOL_COROUTINE_HPP
+#define THREADPOOL_COROUTINE_HPP
+
+/*
+
+-- Part of KozyLibrary/DataStructures
+
+*/
+
+#include <coroutine>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <variant>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+#include "ThreadPool.hpp"
+
+
+namespace KozyLibrary {
+
+template<typename ResultT = void> class Task;
+
+/*
+	stores the result or the exception of a Task.
+*/
+template<typename ResultT>
+class TaskPromise_Result {
+public:
+	template<typename ValueT>
+	void return_value(ValueT&& val) {
+		value.emplace(std::forward<ValueT>(val));
+	}
+
+	void unhandled_exception() noexcept {
+		exception = std::current_exception();
+	}
+
+	/*
+		UB if the Task did not finish or the result was already taken.
+	*/
+	ResultT take_Result() {
+		if (exception){
+			std::rethrow_exception(exception);
+		}
+		return std::move(*value);
+	}
+
+private:
+	std::optional<ResultT> value{};
+	std::exception_ptr exception{};
+};
+
+template<>
+class TaskPromise_Result<void> {
+public:
+	void return_void() noexcept {
+
+	}
+
+	void unhandled_exception() noexcept {
+		exception = std::current_exception();
+	}
+
+	void take_Result() {
+		if (exception){
+			std::rethrow_exception(exception);
+		}
+	}
+
+private:
+	std::exception_ptr exception{};
+};
+
+
+/*
+* DESCRIPTION *
+
+A coroutine, that returns a ResultT.
+A Task is lazy: it starts when it is awaited, on the thread that awaits it, and runs until it suspends.
+When it finishes, the awaiting coroutine is resumed right away on the same thread, without going through a queue.
+
+So a Task, that starts with
+	co_await pool.schedule();
+hops onto a worker of pool, and everything that awaits it continues on the pool as well.
+
+Use when_all() to await several Tasks together and sync_wait() to wait for a Task in a function, that is not a coroutine.
+
+Assumptions:
+- ResultT is not a reference.
+- a Task is awaited at most once.
+
+
+* OTHER *
+
+promise_type		: required by the compiler, not meant to be used directly.
+
+*/
+template<typename ResultT>
+class Task {
+public:
+	class promise_type;
+	using handleT = std::coroutine_handle<promise_type>;
+
+
+	Task() noexcept = default;
+
+	Task(Task&& mv) noexcept:
+		handle(std::exchange(mv.handle, nullptr))
+	{
+
+	}
+
+	Task& operator=(Task&& mv) noexcept {
+		if (this != &mv){
+			reset();
+			handle = std::exchange(mv.handle, nullptr);
+		}
+		return *this;
+	}
+
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+
+	/*
+		destroys the coroutine. UB while it is running.
+	*/
+	~Task() {
+		reset();
+	}
+
+	bool is_valid() const noexcept {
+		return static_cast<bool>(handle);
+	}
+
+	/*
+		returns true if the Task finished.
+	*/
+	bool is_ready() const noexcept {
+		return handle && handle.done();
+	}
+
+	/*
+		co_await std::move(task) starts the Task and returns its result or rethrows its exception.
+	*/
+	auto operator co_await() && noexcept {
+		return ResultAwaiter{handle};
+	}
+
+	/*
+		co_await task.when_ready() starts the Task and waits until it finished, without taking the result.
+		take_Result() returns it afterwards.
+	*/
+	auto when_ready() noexcept {
+		return ReadyAwaiter{handle};
+	}
+
+	/*
+		returns the result or rethrows the exception of the Task.
+		UB if the Task did not finish or the result was already taken.
+	*/
+	ResultT take_Result() {
+		return handle.promise().take_Result();
+	}
+
+private:
+
+	struct ReadyAwaiter {
+		bool await_ready() const noexcept {
+			return !handle || handle.done();
+		}
+
+		/*
+			starts the Task by symmetric transfer, so that deep chains of Tasks do not grow the stack.
+		*/
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+
+		void await_resume() const noexcept {
+
+		}
+
+		handleT handle;
+	};
+
+	struct ResultAwaiter : ReadyAwaiter {
+		ResultT await_resume() {
+			return this->handle.promise().take_Result();
+		}
+	};
+
+	explicit Task(handleT arg_handle) noexcept:
+		handle(arg_handle)
+	{
+
+	}
+
+	void reset() noexcept {
+		if (handle){
+			handle.destroy();
+			handle = nullptr;
+		}
+	}
+
+	handleT handle{};
+};
+
+template<typename ResultT>
+class Task<ResultT>::promise_type : public TaskPromise_Result<ResultT> {
+public:
+
+	/*
+		resumes the awaiting coroutine on the thread that finished the Task.
+	*/
+	struct FinalAwaiter {
+		bool await_ready() const noexcept {
+			return false;
+		}
+
+		std::coroutine_handle<> await_suspend(handleT finished) noexcept {
+			const std::coroutine_handle<> continuation = finished.promise().continuation;
+			return continuation? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept {
+
+		}
+	};
+
+	Task get_return_object() noexcept {
+		return Task(handleT::from_promise(*this));
+	}
+
+	std::suspend_always initial_suspend() const noexcept {
+		return {};
+	}
+
+	FinalAwaiter final_suspend() const noexcept {
+		return {};
+	}
+
+	std::coroutine_handle<> continuation{};
+};
+
+
+/*
+	gets told by a TaskNotifier, that the Task it awaited finished.
+	returns the coroutine, that has to be resumed now.
+*/
+class TaskSignal {
+public:
+	virtual std::coroutine_handle<> notify() noexcept = 0;
+
+protected:
+	~TaskSignal() = default;
+};
+
+/*
+	a coroutine, that awaits one Task and then notifies a TaskSignal.
+	used by when_all() and sync_wait(), which start it and destroy it.
+*/
+class TaskNotifier {
+public:
+	class promise_type {
+	public:
+		struct FinalAwaiter {
+			bool await_ready() const noexcept {
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> finished) noexcept {
+				return finished.promise().signal->notify();
+			}
+
+			void await_resume() const noexcept {
+
+			}
+		};
+
+		TaskNotifier get_return_object() noexcept {
+			return TaskNotifier(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() const noexcept {
+			return {};
+		}
+
+		FinalAwaiter final_suspend() const noexcept {
+			return {};
+		}
+
+		void return_void() noexcept {
+
+		}
+
+		void unhandled_exception() noexcept {
+			std::terminate(); // when_ready() does not throw
+		}
+
+		TaskSignal* signal{nullptr};
+	};
+
+	template<typename ResultT>
+	static TaskNotifier await_Task(Task<ResultT>& task) {
+		co_await task.when_ready();
+	}
+
+	TaskNotifier(TaskNotifier&& mv) noexcept:
+		handle(std::exchange(mv.handle, nullptr))
+	{
+
+	}
+
+	TaskNotifier(const TaskNotifier&) = delete;
+	TaskNotifier& operator=(const TaskNotifier&) = delete;
+	TaskNotifier& operator=(TaskNotifier&&) = delete;
+
+	~TaskNotifier() {
+		if (handle){
+			handle.destroy();
+		}
+	}
+
+	void start(TaskSignal& signal) {
+		handle.promise().signal = &signal;
+		handle.resume();
+	}
+
+private:
+	explicit TaskNotifier(std::coroutine_handle<promise_type> arg_handle) noexcept:
+		handle(arg_handle)
+	{
+
+	}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+/*
+	starts every TaskNotifier and resumes the awaiting coroutine, after the last awaited Task finished.
+	the count starts one higher than the number of Tasks, so that the awaiting coroutine is not resumed before all were started.
+*/
+class WhenAllAwaiter : private TaskSignal {
+public:
+	WhenAllAwaiter(TaskNotifier* arg_notifiers, std::size_t arg_cnt) noexcept:
+		notifiers(arg_notifiers),
+		cnt(arg_cnt),
+		remainingCnt(arg_cnt + 1)
+	{
+
+	}
+
+	bool await_ready() const noexcept {
+		return cnt == 0;
+	}
+
+	bool await_suspend(std::coroutine_handle<> arg_awaiting) {
+		awaiting = arg_awaiting;
+		for (std::size_t pos = 0; pos != cnt; ++pos){
+			notifiers[pos].start(*this);
+		}
+		return --remainingCnt != 0;
+	}
+
+	void await_resume() const noexcept {
+
+	}
+
+private:
+	std::coroutine_handle<> notify() noexcept override {
+		return (--remainingCnt == 0)? awaiting : std::noop_coroutine();
+	}
+
+	TaskNotifier* notifiers;
+	std::size_t cnt;
+	std::atomic<std::size_t> remainingCnt;
+	std::coroutine_handle<> awaiting{};
+};
+
+
+/*
+	the type, that when_all() returns for a Task<ResultT>: ResultT, or std::monostate for void.
+*/
+template<typename ResultT>
+using WhenAll_Result = std::conditional_t<std::is_void_v<ResultT>, std::monostate, ResultT>;
+
+template<typename ResultT>
+WhenAll_Result<ResultT> take_WhenAllResult(Task<ResultT>& task) {
+	if constexpr (std::is_void_v<ResultT>){
+		task.take_Result();
+		return std::monostate{};
+	} else {
+		return task.take_Result();
+	}
+}
+
+/*
+	starts all tasks, one after another on the awaiting thread, and finishes when all of them finished.
+	the awaiting coroutine continues on the thread, that finished the last Task.
+	Tasks, that begin with co_await pool.schedule(), run in parallel.
+
+	returns the results in the order of the arguments.
+	if Tasks threw, all Tasks are still waited for and the exception of the first of them is rethrown.
+*/
+template<typename... ResultTs> requires (sizeof...(ResultTs) != 0)
+Task<std::tuple<WhenAll_Result<ResultTs>...>> when_all(Task<ResultTs>... tasks) {
+	TaskNotifier notifiers[] = { TaskNotifier::await_Task(tasks)... };
+	co_await WhenAllAwaiter(notifiers, sizeof...(ResultTs));
+
+	co_return std::tuple<WhenAll_Result<ResultTs>...>{ take_WhenAllResult(tasks)... };
+}
+
+/*
+	see when_all() above. returns the results in the order of tasks.
+*/
+template<typename ResultT> requires (!std::is_void_v<ResultT>)
+Task<std::vector<ResultT>> when_all(std::vector<Task<ResultT>> tasks) {
+	std::vector<TaskNotifier> notifiers;
+	notifiers.reserve(tasks.size());
+	for (auto& e : tasks){
+		notifiers.emplace_back(TaskNotifier::await_Task(e));
+	}
+	co_await WhenAllAwaiter(notifiers.data(), notifiers.size());
+
+	std::vector<ResultT> res;
+	res.reserve(tasks.size());
+	for (auto& e : tasks){
+		res.emplace_back(e.take_Result());
+	}
+	co_return res;
+}
+
+/*
+	see when_all() above.
+*/
+inline Task<void> when_all(std::vector<Task<void>> tasks) {
+	std::vector<TaskNotifier> notifiers;
+	notifiers.reserve(tasks.size());
+	for (auto& e : tasks){
+		notifiers.emplace_back(TaskNotifier::await_Task(e));
+	}
+	co_await WhenAllAwaiter(notifiers.data(), notifiers.size());
+
+	for (auto& e : tasks){
+		e.take_Result();
+	}
+}
+
+
+/*
+	blocks the calling thread until the Task was notified.
+*/
+class SyncWaitSignal : private TaskSignal {
+public:
+	void start(TaskNotifier& notifier) {
+		notifier.start(*this);
+	}
+
+	void wait() {
+		std::unique_lock lock(guard);
+		finished.wait(lock, [this](){ return isDone; });
+	}
+
+private:
+	std::coroutine_handle<> notify() noexcept override {
+		std::lock_guard lock(guard); // the waiting thread destroys this signal as soon as it can lock
+		isDone = true;
+		finished.notify_one();
+		return std::noop_coroutine();
+	}
+
+	std::mutex guard{};
+	std::condition_variable finished{};
+	bool isDone{false};
+};
+
+/*
+	starts task on the calling thread, blocks until it finished and returns its result or rethrows its exception.
+	Deadlocks if it is called by work of the ThreadPool that task needs, while no other worker is left.
+*/
+template<typename ResultT>
+ResultT sync_wait(Task<ResultT> task) {
+	SyncWaitSignal signal;
+	TaskNotifier notifier = TaskNotifier::await_Task(task);
+	signal.start(notifier);
+	signal.wait();
+	return task.take_Result();
+}
+
+}
+
+#endif
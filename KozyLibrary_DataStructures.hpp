@@ -2,8 +2,11 @@
 #define KOZYLIBRARY_DATASTRUCTURES_HPP
 
 #include "DataStructures/K_Tree.hpp"
+#include "DataStructures/K_Tree_Concurrent.hpp"
 #include "DataStructures/CompileTime_String.hpp"
 #include "DataStructures/ThreadPool.hpp"
+#include "DataStructures/TaskGraph.hpp"
+#include "DataStructures/ThreadPool_Coroutine.hpp"
 #include "DataStructures/OptionalMember.hpp"
 #include "DataStructures/Image_PixelArray.hpp"
 
@@ -0,0 +1,880 @@
+#include "DataStructures/K_Tree.hpp"
+#include "DataStructures/K_Tree_Concurrent.hpp"
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <array>
+
+using namespace std;
+
+
+struct Point {
+    int x, y;
+};
+
+static atomic<size_t> compareCnt{0}; // make_Balanced compares on several threads
+
+static bool bigger_x(const Point& lhs, const Point& rhs) {
+    ++compareCnt;
+    return lhs.x > rhs.x;
+}
+static bool bigger_y(const Point& lhs, const Point& rhs) {
+    return lhs.y > rhs.y;
+}
+
+static constexpr bool (* const comparePoint[2]) (const Point&, const Point&) = {bigger_x, bigger_y};
+
+using PointTree = KozyLibrary::K_Tree<Point, 2, comparePoint>;
+
+
+static int failures = 0;
+
+static void check(bool condition, const char* name) {
+    cout << (condition? "passed: " : "FAILED: ") << name << endl;
+    if (!condition){
+        ++failures;
+    }
+}
+
+/*
+    a scattered, but reproducible set of unique points.
+*/
+static vector<Point> make_Points(int cnt) {
+    vector<Point> res;
+    res.reserve(cnt);
+    uint_fast32_t state = 12345;
+    for (int i = 0; i != cnt; ++i){
+        state = state * 1664525u + 1013904223u;
+        res.push_back({static_cast<int>(state % 1000), i});
+    }
+    return res;
+}
+
+/*
+    every node is in the bucket of its parent, that its element compares to, points back to its parent and is reached exactly once.
+*/
+template<typename NodeT>
+static bool is_valid(const NodeT* node, size_t& nodeCnt) {
+    ++nodeCnt;
+    for (size_t pos = 0; pos != node->get_childEnd(); ++pos){
+        const NodeT* const child = node->get_childAt(pos);
+        if (!child){
+            continue;
+        }
+        const size_t bucket = node->get_bucketAt(pos);
+        const size_t expected = (bigger_x(**node, **child)? 1 : 0) + (bigger_y(**node, **child)? 2 : 0);
+        if (expected != bucket || node->get_child(bucket) != child || child->parent != node || !is_valid(child, nodeCnt)){
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t count_byIterator(PointTree& tree) {
+    size_t res = 0;
+    for (auto iter = tree.begin(), end = tree.end(); iter != end; ++iter){
+        ++res;
+    }
+    return res;
+}
+
+/*
+    the nodes come from slabs, reserve() allocates them up front, and moving a tree moves its slabs.
+*/
+static void test_arena() {
+    vector<Point> points = make_Points(100000);
+
+    PointTree tree;
+    tree.reserve(points.size());
+    const size_t capacity = tree.get_capacity();
+    for (auto& e : points){
+        tree.push(e);
+    }
+    size_t nodeCnt = 0;
+    check(is_valid(tree.get_root(), nodeCnt) && nodeCnt == points.size() && tree.get_nodeCnt() == points.size(), "every element is pushed into its bucket");
+    check(capacity == points.size() && tree.get_capacity() == capacity, "reserve allocates all nodes up front");
+    check(count_byIterator(tree) == points.size(), "the iterator visits every node");
+
+    PointTree grown(points.data(), 1000);
+    grown.push_array(points.data() + 1000, 5000);
+    check(grown.get_nodeCnt() == 6000 && grown.get_capacity() >= 6000 && count_byIterator(grown) == 6000, "push_array reserves the nodes it needs");
+
+    PointTree moved(std::move(tree));
+    check(tree.is_empty() && tree.get_nodeCnt() == 0 && moved.get_nodeCnt() == points.size() && count_byIterator(moved) == points.size(), "moving a tree moves its nodes");
+
+    moved = std::move(grown);
+    check(grown.is_empty() && moved.get_nodeCnt() == 6000 && count_byIterator(moved) == 6000, "move assignment releases the old nodes");
+
+    PointTree small;
+    for (int i = 0; i != 1000; ++i){
+        small.push(points[i]);
+    }
+    check(small.get_nodeCnt() == 1000 && count_byIterator(small) == 1000, "slabs grow while pushing");
+}
+
+/*
+    the nodes in the order, that the Iterator has to visit them: a node before its children, the children in the order of their buckets.
+*/
+template<typename NodeT>
+static void collect_Preorder(NodeT* node, vector<NodeT*>& out) {
+    out.push_back(node);
+    for (size_t pos = 0; pos != node->get_childEnd(); ++pos){
+        if (NodeT* const child = node->get_childAt(pos)){
+            collect_Preorder(child, out);
+        }
+    }
+}
+
+/*
+    the Iterator walks over the parents of the nodes, so that it is cheap to copy, and for_each visits the same nodes.
+*/
+static void test_iterator() {
+    vector<Point> points = make_Points(20000);
+    PointTree tree(points.data(), points.size());
+
+    vector<PointTree::Node*> expected;
+    collect_Preorder(tree.get_root(), expected);
+
+    vector<PointTree::Node*> visited;
+    for (auto iter = tree.begin(), end = tree.end(); iter != end; ++iter){
+        visited.push_back(&*iter);
+    }
+    check(visited == expected, "the Iterator visits a node before its children");
+
+    auto iter = tree.begin();
+    for (int i = 0; i != 500; ++i){
+        ++iter;
+    }
+    auto copy = iter;
+    bool isSame = true;
+    for (size_t pos = 500; pos != 1500; ++pos){
+        isSame &= (&*iter == expected[pos]);
+        ++iter;
+    }
+    for (size_t pos = 500; pos != 1500; ++pos){
+        isSame &= (&*copy == expected[pos]);
+        ++copy;
+    }
+    check(isSame, "a copied Iterator continues on its own");
+
+    PointTree::Node* subtree = nullptr;
+    for (size_t bucket = 0; bucket != PointTree::BUCKET_CNT; ++bucket){
+        PointTree::Node* const child = tree.get_root()->get_child(bucket);
+        if (child && (!subtree || child->get_child(0))){
+            subtree = child;
+        }
+    }
+    vector<PointTree::Node*> expectedSubtree;
+    collect_Preorder(subtree, expectedSubtree);
+    vector<PointTree::Node*> visitedSubtree;
+    for (auto iter = tree.begin(subtree), end = tree.end(); iter != end; ++iter){
+        visitedSubtree.push_back(&*iter);
+    }
+    check(visitedSubtree == expectedSubtree, "an Iterator started at a node stays below it");
+
+    vector<const Point*> elements;
+    tree.for_each([&](Point& e){ elements.push_back(&e); });
+    bool isSameOrder = elements.size() == expected.size();
+    for (size_t pos = 0; isSameOrder && pos != expected.size(); ++pos){
+        isSameOrder = (elements[pos] == expected[pos]->value);
+    }
+    check(isSameOrder, "for_each visits the elements in the order of the Iterator");
+
+    const PointTree& constTree = tree;
+    size_t cnt = 0;
+    constTree.for_each([&](const Point&){ ++cnt; });
+    PointTree empty;
+    empty.for_each([&](Point&){ ++cnt; });
+    check(cnt == points.size() && empty.begin() == empty.end(), "for_each over a const and an empty tree");
+}
+
+static bool is_inBox(const Point& e, const Point& lhs, const Point& rhs) {
+    return lhs.x <= e.x && e.x <= rhs.x && lhs.y <= e.y && e.y <= rhs.y;
+}
+
+/*
+    range queries find the same elements as a filter over all of them, but compare only a fraction of the tree.
+*/
+static void test_range() {
+    vector<Point> points = make_Points(20000);
+    for (size_t pos = 0; pos != points.size(); ++pos){ // y should not follow the insertion order, so that the tree stays flat
+        points[pos].y = static_cast<int>((pos * 7919) % points.size());
+    }
+    PointTree tree(points.data(), points.size());
+
+    bool isSame = true;
+    uint_fast32_t state = 777;
+    for (int query = 0; query != 200; ++query){
+        state = state * 1664525u + 1013904223u;
+        const Point lhs{static_cast<int>(state % 1000), static_cast<int>((state >> 10) % 20000)};
+        const Point rhs{lhs.x + static_cast<int>(state % 97), lhs.y + static_cast<int>((state >> 4) % 1500)};
+
+        vector<const Point*> expected;
+        for (auto& e : points){
+            if (is_inBox(e, lhs, rhs)){
+                expected.push_back(&e);
+            }
+        }
+        sort(expected.begin(), expected.end());
+
+        vector<const Point*> byIterator;
+        for (auto& node : tree.get_range(lhs, rhs)){
+            byIterator.push_back(node.value);
+        }
+        sort(byIterator.begin(), byIterator.end());
+
+        vector<const Point*> byCallback;
+        tree.for_range(lhs, rhs, [&](Point& e){ byCallback.push_back(&e); });
+        sort(byCallback.begin(), byCallback.end());
+
+        isSame &= (byIterator == expected && byCallback == expected && tree.count_range(lhs, rhs) == expected.size());
+    }
+    check(isSame, "get_range, for_range and count_range find the elements inside of the box");
+
+    const Point all_lhs{-1, -1};
+    const Point all_rhs{1000, 20000};
+    check(tree.count_range(all_lhs, all_rhs) == points.size(), "a box around all elements finds all of them");
+
+    const Point inverted_lhs{500, 0};
+    const Point inverted_rhs{400, 20000};
+    check(tree.count_range(inverted_lhs, inverted_rhs) == 0 && tree.get_range(inverted_lhs, inverted_rhs).begin() == tree.get_range(inverted_lhs, inverted_rhs).end(), "an inverted box is empty");
+
+    const Point small_lhs{100, 100};
+    const Point small_rhs{110, 400};
+    compareCnt = 0;
+    tree.count_range(small_lhs, small_rhs);
+    check(compareCnt < points.size() / 4, "a small box compares only a part of the tree");
+
+    PointTree empty;
+    check(empty.count_range(small_lhs, small_rhs) == 0, "a range of an empty tree is empty");
+}
+
+static long long squared_distance(const Point& lhs, const Point& rhs) {
+    const long long dx = lhs.x - rhs.x;
+    const long long dy = lhs.y - rhs.y;
+    return dx*dx + dy*dy;
+}
+
+static long long squared_axisDistance(uint_fast8_t property, const Point& query, const Point& element) {
+    const long long d = (property == 0)? query.x - element.x : query.y - element.y;
+    return d*d;
+}
+
+/*
+    the distances of the k closest elements, the closest first, by comparing all of them.
+*/
+static vector<long long> nearest_byFilter(const vector<Point>& points, const Point& query, size_t k) {
+    vector<long long> res;
+    for (auto& e : points){
+        res.push_back(squared_distance(query, e));
+    }
+    k = min(k, res.size());
+    partial_sort(res.begin(), res.begin() + k, res.end());
+    res.resize(k);
+    return res;
+}
+
+template<typename NeighbourT>
+static vector<long long> get_distances(const vector<NeighbourT>& neighbours, const Point& query) {
+    vector<long long> res;
+    for (auto& e : neighbours){
+        if (e.distance != squared_distance(query, **e.node)){
+            return {};
+        }
+        res.push_back(e.distance);
+    }
+    return res;
+}
+
+/*
+    nearest and nearest_batch find the closest elements, in order, and skip most of the tree.
+*/
+static void test_nearest() {
+    vector<Point> points = make_Points(20000);
+    for (size_t pos = 0; pos != points.size(); ++pos){
+        points[pos].y = static_cast<int>((pos * 7919) % 1000);
+    }
+    PointTree tree(points.data(), points.size());
+
+    vector<Point> queries;
+    uint_fast32_t state = 4242;
+    for (int i = 0; i != 300; ++i){
+        state = state * 1664525u + 1013904223u;
+        queries.push_back({static_cast<int>(state % 1100) - 50, static_cast<int>((state >> 12) % 1100) - 50});
+    }
+
+    bool isSame = true;
+    for (auto& query : queries){
+        for (size_t k : {size_t(1), size_t(8), size_t(50)}){
+            isSame &= (get_distances(tree.nearest(query, k, squared_distance, squared_axisDistance), query) == nearest_byFilter(points, query, k));
+        }
+    }
+    check(isSame, "nearest finds the k closest elements, the closest first");
+
+    const auto batch = tree.nearest_batch(queries.begin(), queries.size(), 8, squared_distance, squared_axisDistance);
+    bool isSameBatch = batch.size() == queries.size();
+    for (size_t pos = 0; isSameBatch && pos != queries.size(); ++pos){
+        isSameBatch = (get_distances(batch[pos], queries[pos]) == nearest_byFilter(points, queries[pos], 8));
+    }
+    check(isSameBatch, "nearest_batch answers every query at its position");
+
+    compareCnt = 0;
+    tree.nearest(queries[0], 8, squared_distance, squared_axisDistance);
+    check(compareCnt < points.size() / 10, "nearest compares only a part of the tree");
+
+    PointTree small(points.data(), 5);
+    PointTree empty;
+    check(small.nearest(queries[0], 8, squared_distance, squared_axisDistance).size() == 5
+        && empty.nearest(queries[0], 8, squared_distance, squared_axisDistance).empty()
+        && tree.nearest(queries[0], 0, squared_distance, squared_axisDistance).empty(), "nearest on small trees and for k = 0");
+}
+
+/*
+    make_Balanced builds a shallow tree from sorted elements, on the calling thread and on a ThreadPool alike.
+*/
+static void test_balanced() {
+    vector<Point> sorted;
+    for (int i = 0; i != 100000; ++i){
+        sorted.push_back({i, i / 3});
+    }
+
+    PointTree chain;
+    for (int i = 0; i != 2000; ++i){
+        chain.push(sorted[i]);
+    }
+
+    PointTree tree = PointTree::make_Balanced(sorted.begin(), sorted.size());
+    size_t nodeCnt = 0;
+    check(is_valid(tree.get_root(), nodeCnt) && nodeCnt == sorted.size() && tree.get_nodeCnt() == sorted.size(), "make_Balanced puts every element into its bucket");
+    check(chain.get_height() == 2000 && tree.get_height() <= 2*17, "make_Balanced is O(log n) deep, where pushing sorted elements makes a chain");
+
+    const Point lhs{1000, 0};
+    const Point rhs{1999, 100000};
+    check(tree.count_range(lhs, rhs) == 1000, "a balanced tree answers range queries");
+
+    KozyLibrary::ThreadPool pool;
+    pool.start(4);
+    PointTree parallel = PointTree::make_Balanced(sorted.begin(), sorted.size(), pool);
+    vector<PointTree::Node*> expected;
+    collect_Preorder(tree.get_root(), expected);
+    vector<PointTree::Node*> visited;
+    collect_Preorder(parallel.get_root(), visited);
+    bool isSame = expected.size() == visited.size();
+    for (size_t pos = 0; isSame && pos != expected.size(); ++pos){
+        isSame = (expected[pos]->value == visited[pos]->value);
+    }
+    nodeCnt = 0;
+    check(isSame && is_valid(parallel.get_root(), nodeCnt) && nodeCnt == sorted.size(), "make_Balanced on a ThreadPool builds the same tree");
+    pool.stop();
+    pool.wait_untilStopped();
+
+    PointTree stopped = PointTree::make_Balanced(sorted.begin(), 5000, pool);
+    PointTree empty = PointTree::make_Balanced(sorted.begin(), 0);
+    check(stopped.get_nodeCnt() == 5000 && count_byIterator(stopped) == 5000 && empty.is_empty(), "make_Balanced without running workers and without elements");
+}
+
+using SparsePointTree = KozyLibrary::K_Tree<Point, 2, comparePoint, KozyLibrary::K_TreeChildren::sparse>;
+
+template<typename TreeT>
+static vector<const Point*> get_elements(TreeT& tree) {
+    vector<const Point*> res;
+    tree.for_each([&](Point& e){ res.push_back(&e); });
+    return res;
+}
+
+struct Point8 {
+    int v[8];
+};
+
+template<size_t PROPERTY>
+static bool bigger_v(const Point8& lhs, const Point8& rhs) {
+    return lhs.v[PROPERTY] > rhs.v[PROPERTY];
+}
+
+static constexpr bool (* const comparePoint8[8]) (const Point8&, const Point8&) = {
+    bigger_v<0>, bigger_v<1>, bigger_v<2>, bigger_v<3>, bigger_v<4>, bigger_v<5>, bigger_v<6>, bigger_v<7>
+};
+
+/*
+    sparse nodes store only their children, and the tree is the same as with dense nodes.
+*/
+static void test_sparse() {
+    vector<Point> points = make_Points(20000);
+    for (size_t pos = 0; pos != points.size(); ++pos){
+        points[pos].y = static_cast<int>((pos * 7919) % 1000);
+    }
+
+    PointTree dense(points.data(), points.size());
+    SparsePointTree sparse(points.data(), points.size());
+    size_t nodeCnt = 0;
+    check(is_valid(sparse.get_root(), nodeCnt) && nodeCnt == points.size() && get_elements(sparse) == get_elements(dense), "sparse nodes build the same tree as dense nodes");
+
+    SparsePointTree balanced = SparsePointTree::make_Balanced(points.begin(), points.size());
+    PointTree denseBalanced = PointTree::make_Balanced(points.begin(), points.size());
+    nodeCnt = 0;
+    check(is_valid(balanced.get_root(), nodeCnt) && nodeCnt == points.size() && get_elements(balanced) == get_elements(denseBalanced), "make_Balanced with sparse nodes");
+
+    KozyLibrary::ThreadPool pool;
+    pool.start(4);
+    SparsePointTree parallel = SparsePointTree::make_Balanced(points.begin(), points.size(), pool);
+    check(get_elements(parallel) == get_elements(denseBalanced), "make_Balanced with sparse nodes on a ThreadPool");
+
+    const Point lhs{100, 100};
+    const Point rhs{400, 300};
+    const Point query{500, 500};
+    auto denseNearest = dense.nearest(query, 10, squared_distance, squared_axisDistance);
+    auto sparseNearest = sparse.nearest(query, 10, squared_distance, squared_axisDistance);
+    check(dense.count_range(lhs, rhs) == sparse.count_range(lhs, rhs)
+        && get_distances(denseNearest, query) == get_distances(sparseNearest, query), "range queries and nearest with sparse nodes");
+
+    vector<Point8> points8;
+    uint_fast32_t state = 99;
+    for (int i = 0; i != 5000; ++i){
+        Point8 e;
+        for (int& v : e.v){
+            state = state * 1664525u + 1013904223u;
+            v = static_cast<int>(state >> 8);
+        }
+        points8.push_back(e);
+    }
+    KozyLibrary::Basic_K_Tree<Point8, KozyLibrary::K_TreeFunctionArray<Point8, 8, comparePoint8>> tree8(points8.data(), points8.size());
+    using Dense8 = KozyLibrary::K_Tree<Point8, 8, comparePoint8>;
+    Dense8 dense8(points8.data(), points8.size());
+    vector<const Point8*> elements8, denseElements8;
+    tree8.for_each([&](Point8& e){ elements8.push_back(&e); });
+    dense8.for_each([&](Point8& e){ denseElements8.push_back(&e); });
+    check(sizeof(decltype(tree8)::Node) * 16 < sizeof(Dense8::Node) && elements8 == denseElements8 && tree8.get_nodeCnt() == points8.size(),
+        "Basic_K_Tree uses sparse nodes for 8 properties by default, which are a fraction of the size of dense ones");
+    check(Dense8::CHILD_STORAGE == KozyLibrary::K_TreeChildren::dense, "K_Tree keeps dense nodes by default");
+}
+
+/*
+    removal keeps every other element in its bucket and reuses the nodes, with dense and with sparse nodes.
+*/
+template<typename TreeT>
+static void test_remove(const char* name) {
+    cout << name << ":" << endl;
+    vector<Point> points = make_Points(20000);
+    for (size_t pos = 0; pos != points.size(); ++pos){
+        points[pos].y = static_cast<int>((pos * 7919) % points.size());
+    }
+    TreeT tree(points.data(), points.size());
+    const size_t capacity = tree.get_capacity();
+
+    bool isRemoved = true;
+    for (size_t pos = 0; pos < points.size(); pos += 2){
+        const Point copy = points[pos];
+        isRemoved &= (tree.remove_element(copy) == &points[pos]);
+        isRemoved &= (tree.find_Node(copy) == nullptr && tree.remove_element(copy) == nullptr);
+    }
+    vector<const Point*> expected;
+    for (size_t pos = 1; pos < points.size(); pos += 2){
+        expected.push_back(&points[pos]);
+    }
+    vector<const Point*> remaining = get_elements(tree);
+    sort(remaining.begin(), remaining.end());
+    size_t nodeCnt = 0;
+    check(isRemoved && remaining == expected && is_valid(tree.get_root(), nodeCnt) && nodeCnt == expected.size() && tree.get_nodeCnt() == expected.size(),
+        "remove_element takes out every other element and keeps the rest in their buckets");
+
+    Point& rootElement = **tree.get_root();
+    check(&tree.remove_Node(*tree.get_root()) == &rootElement && tree.find_Node(rootElement) == nullptr && tree.get_nodeCnt() == expected.size() - 1, "remove_Node of the root");
+
+    tree.push(rootElement);
+    for (size_t pos = 0; pos < points.size(); pos += 2){
+        tree.push(points[pos]);
+    }
+    nodeCnt = 0;
+    check(is_valid(tree.get_root(), nodeCnt) && nodeCnt == points.size() && tree.get_capacity() == capacity, "pushes reuse the nodes of removed elements");
+
+    for (auto& e : points){
+        tree.remove_element(e);
+    }
+    check(tree.is_empty() && tree.get_nodeCnt() == 0, "removing all elements leaves an empty tree");
+}
+
+/*
+    with rebalancing, sorted pushes and a long churn of removals and pushes keep the tree shallow.
+*/
+static void test_rebalancing() {
+    vector<Point> sorted;
+    for (int i = 0; i != 50000; ++i){
+        sorted.push_back({i, i});
+    }
+
+    PointTree tree;
+    tree.set_rebalancing(0.7);
+    for (int i = 0; i != 10000; ++i){
+        tree.push(sorted[i]);
+    }
+    const double limit = log(10000.0)/-log(0.7) + 2;
+    size_t nodeCnt = 0;
+    check(tree.is_rebalancing() && tree.get_height() <= limit && is_valid(tree.get_root(), nodeCnt) && nodeCnt == 10000, "sorted pushes stay O(log n) deep with rebalancing");
+
+    bool isShallow = true;
+    for (int i = 10000; i != 50000; ++i){
+        Point& pushed = sorted[i];
+        isShallow &= (**&tree.push(pushed)).x == pushed.x;
+        tree.remove_element(sorted[i - 10000]);
+    }
+    nodeCnt = 0;
+    isShallow &= tree.get_height() <= limit;
+    check(isShallow && is_valid(tree.get_root(), nodeCnt) && nodeCnt == 10000 && tree.count_range(sorted[40000], sorted[49999]) == 10000,
+        "a churn of pushes and removals stays shallow");
+
+    tree.disable_rebalancing();
+    PointTree chain;
+    for (int i = 0; i != 2000; ++i){
+        chain.push(sorted[i]);
+    }
+    check(!tree.is_rebalancing() && chain.get_height() == 2000, "without rebalancing sorted pushes make a chain");
+}
+
+struct BiggerX {
+    bool operator()(const Point& lhs, const Point& rhs) const noexcept {
+        return lhs.x > rhs.x;
+    }
+};
+struct BiggerY {
+    bool operator()(const Point& lhs, const Point& rhs) const noexcept {
+        return lhs.y > rhs.y;
+    }
+};
+
+struct MixedPoint {
+    int x;
+    double y;
+    float z;
+};
+
+/*
+    comparator packs and projections build the same trees as the array of function pointers.
+*/
+static void test_comparison() {
+    vector<Point> points = make_Points(20000);
+    for (size_t pos = 0; pos != points.size(); ++pos){
+        points[pos].y = static_cast<int>((pos * 7919) % 1000);
+    }
+    using ComparatorTree = KozyLibrary::Basic_K_Tree<Point, KozyLibrary::K_TreeComparators<BiggerX, BiggerY>>;
+    using ProjectionTree = KozyLibrary::Basic_K_Tree<Point, KozyLibrary::K_TreeProjections<&Point::x, &Point::y>>;
+
+    PointTree tree(points.data(), points.size());
+    ComparatorTree comparators(points.data(), points.size());
+    ProjectionTree projections(points.data(), points.size());
+    check(get_elements(comparators) == get_elements(tree) && get_elements(projections) == get_elements(tree), "comparator packs and projections push into the same buckets");
+    check(PointTree::COMPARE_FUNCTION_ARRAY == comparePoint, "K_Tree still has its COMPARE_FUNCTION_ARRAY");
+
+    PointTree balanced = PointTree::make_Balanced(points.begin(), points.size());
+    ProjectionTree balancedProjections = ProjectionTree::make_Balanced(points.begin(), points.size());
+    ComparatorTree balancedComparators = ComparatorTree::make_Balanced(points.begin(), points.size());
+    check(get_elements(balancedProjections) == get_elements(balanced) && get_elements(balancedComparators) == get_elements(balanced), "make_Balanced compares single properties of the packs");
+
+    const Point lhs{100, 100};
+    const Point rhs{400, 300};
+    check(projections.count_range(lhs, rhs) == tree.count_range(lhs, rhs) && comparators.count_range(lhs, rhs) == tree.count_range(lhs, rhs), "range queries with packs");
+
+    vector<MixedPoint> mixed;
+    vector<array<float, 3>> floats;
+    for (auto& e : points){
+        mixed.push_back({e.x, e.y * 0.5, static_cast<float>(e.x ^ e.y)});
+        floats.push_back({static_cast<float>(e.x), static_cast<float>(e.y), static_cast<float>(e.x ^ e.y)});
+    }
+    KozyLibrary::Basic_K_Tree<MixedPoint, KozyLibrary::K_TreeProjections<&MixedPoint::x, &MixedPoint::y, &MixedPoint::z>> mixedTree(mixed.data(), mixed.size());
+    KozyLibrary::Basic_K_Tree<array<float, 3>, KozyLibrary::K_TreeProjections<
+        [](const array<float, 3>& e){ return e[0]; }, [](const array<float, 3>& e){ return e[1]; }, [](const array<float, 3>& e){ return e[2]; }
+    >> floatTree(floats.data(), floats.size());
+    vector<size_t> mixedOrder, floatOrder;
+    mixedTree.for_each([&](MixedPoint& e){ mixedOrder.push_back(&e - mixed.data()); });
+    floatTree.for_each([&](array<float, 3>& e){ floatOrder.push_back(&e - floats.data()); });
+    check(mixedOrder == floatOrder && mixedOrder.size() == points.size(), "projections of different key types and of float keys");
+}
+
+
+/*
+    a large element, whose tree only caches the coordinates.
+*/
+struct Particle {
+    Point position;
+    double payload[8];
+};
+
+struct ParticlePosition {
+    Point operator()(const Particle& e) const noexcept {
+        return e.position;
+    }
+};
+
+static void test_keyCache() {
+    vector<Point> points = make_Points(20000);
+    for (size_t pos = 0; pos != points.size(); ++pos){
+        points[pos].y = static_cast<int>((pos * 7919) % 1000);
+    }
+    using CachedTree = KozyLibrary::Basic_K_Tree<Point, KozyLibrary::K_TreeProjections<&Point::x, &Point::y>, KozyLibrary::K_TreeChildren::dense, KozyLibrary::K_TreeCopyKey>;
+
+    PointTree tree(points.data(), points.size());
+    CachedTree cached(points.data(), points.size());
+    size_t nodeCnt = 0;
+    check(is_valid(cached.get_root(), nodeCnt) && nodeCnt == points.size() && get_elements(cached) == get_elements(tree), "nodes with cached keys build the same tree");
+
+    const Point lhs{100, 100};
+    const Point rhs{400, 300};
+    size_t iterated = 0;
+    for (auto& node : cached.get_range(lhs, rhs)){
+        iterated += is_inBox(*node, lhs, rhs)? 1 : 0;
+    }
+    const Point query{500, 500};
+    check(cached.count_range(lhs, rhs) == tree.count_range(lhs, rhs) && iterated == tree.count_range(lhs, rhs)
+        && get_distances(cached.nearest(query, 8, squared_distance, squared_axisDistance), query) == nearest_byFilter(points, query, 8), "range queries and nearest with cached keys");
+
+    CachedTree balanced = CachedTree::make_Balanced(points.begin(), points.size());
+    PointTree denseBalanced = PointTree::make_Balanced(points.begin(), points.size());
+    check(get_elements(balanced) == get_elements(denseBalanced), "make_Balanced with cached keys");
+
+    vector<Particle> particles;
+    for (auto& e : points){
+        particles.push_back({e, {}});
+    }
+    KozyLibrary::Basic_K_Tree<Particle, KozyLibrary::K_TreeProjections<&Point::x, &Point::y>, KozyLibrary::K_TreeChildren::dense, ParticlePosition> particleTree(particles.data(), particles.size());
+    vector<size_t> particleOrder, pointOrder;
+    particleTree.for_each([&](Particle& e){ particleOrder.push_back(&e - particles.data()); });
+    tree.for_each([&](Point& e){ pointOrder.push_back(&e - points.data()); });
+    const Particle& found = **particleTree.find_Node(particles[1234]);
+    check(particleOrder == pointOrder && &found == &particles[1234] && particleTree.count_range(Particle{lhs, {}}, Particle{rhs, {}}) == tree.count_range(lhs, rhs),
+        "a key extractor caches only the compared part of an element");
+}
+
+/*
+    pushes, removals and reads on a ThreadPool at the same time, and the reuse of unlinked nodes.
+*/
+static void test_concurrent() {
+    vector<Point> points = make_Points(20000);
+    vector<Point> extra = make_Points(10000);
+    for (auto& e : extra){
+        e.y += static_cast<int>(points.size());
+    }
+    using ConcurrentTree = KozyLibrary::Concurrent_K_Tree<Point, KozyLibrary::K_TreeProjections<&Point::x, &Point::y>>;
+    KozyLibrary::ThreadPool pool;
+    pool.start(4);
+
+    ConcurrentTree tree;
+    pool.parallel_for(size_t{0}, points.size(), [&](size_t pos){ tree.push(points[pos]); });
+    vector<const Point*> visited;
+    tree.for_each([&](Point& e){ visited.push_back(&e); });
+    sort(visited.begin(), visited.end());
+    bool isFound = true;
+    for (auto& e : points){
+        isFound &= (tree.find(e) == &e);
+    }
+    PointTree reference(points.data(), points.size());
+    const Point lhs{100, 1000};
+    const Point rhs{400, 5000};
+    check(tree.get_nodeCnt() == points.size() && visited.size() == points.size() && adjacent_find(visited.begin(), visited.end()) == visited.end()
+        && isFound && tree.count_range(lhs, rhs) == reference.count_range(lhs, rhs), "parallel pushes into a Concurrent_K_Tree");
+
+    atomic<bool> isRemoved{true};
+    atomic<bool> isCountBounded{true};
+    pool.parallel_for(0, 3, [&](int role){
+        if (role == 0){
+            ConcurrentTree::Guard guard = tree.pin();
+            for (size_t pos = 0; pos < points.size(); pos += 2){
+                if (tree.remove_element(points[pos], guard) != &points[pos]){
+                    isRemoved = false;
+                }
+            }
+        } else if (role == 1){
+            for (auto& e : extra){
+                tree.push(e);
+            }
+        } else {
+            for (int i = 0; i != 20; ++i){
+                if (tree.count_range(lhs, rhs) > reference.count_range(lhs, rhs)){
+                    isCountBounded = false;
+                }
+            }
+        }
+    }, 1);
+    vector<const Point*> expected;
+    for (size_t pos = 1; pos < points.size(); pos += 2){
+        expected.push_back(&points[pos]);
+    }
+    for (auto& e : extra){
+        expected.push_back(&e);
+    }
+    sort(expected.begin(), expected.end());
+    visited.clear();
+    tree.for_each([&](Point& e){ visited.push_back(&e); });
+    sort(visited.begin(), visited.end());
+    check(isRemoved && isCountBounded && visited == expected && tree.get_nodeCnt() == expected.size(), "removals, pushes and readers at the same time");
+
+    pool.parallel_for(size_t{0}, expected.size(), [&](size_t pos){ tree.remove_element(*expected[pos]); });
+    const size_t capacity = tree.get_capacity();
+    for (int i = 0; i != 3; ++i){
+        tree.reclaim();
+    }
+    for (auto& e : points){
+        tree.push(e);
+    }
+    check(tree.get_capacity() == capacity && tree.get_nodeCnt() == points.size() && tree.count_range(lhs, rhs) == reference.count_range(lhs, rhs),
+        "unlinked nodes are reused after the epoch moved on");
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    push_batch builds the same tree as pushing one after another, find_batch and the range batches answer like their single versions.
+*/
+template<typename TreeT>
+static void test_batch(const char* name) {
+    cout << name << ":" << endl;
+    vector<Point> points = make_Points(20000);
+    for (size_t pos = 0; pos != points.size(); ++pos){
+        points[pos].y = static_cast<int>((pos * 7919) % points.size());
+    }
+
+    TreeT single;
+    single.push_array(points.begin(), points.size());
+    TreeT batch;
+    batch.push_batch(points.begin(), points.size() / 4);
+    batch.push_batch(points.begin() + points.size() / 4, points.size() - points.size() / 4);
+    size_t nodeCnt = 0;
+    check(is_valid(batch.get_root(), nodeCnt) && nodeCnt == points.size() && get_elements(batch) == get_elements(single), "push_batch builds the same tree as push_array");
+
+    vector<Point> queries(points.begin(), points.begin() + 1000);
+    queries.push_back({-1, -1});
+    queries.push_back({5000, 0});
+    auto found = batch.find_batch(queries.begin(), queries.size());
+    bool isSame = (found.size() == queries.size());
+    for (size_t pos = 0; isSame && pos != queries.size(); ++pos){
+        isSame = (found[pos] == batch.find_Node(queries[pos]));
+    }
+    check(isSame && found[0] != nullptr && found.back() == nullptr, "find_batch finds the same nodes as find_Node");
+
+    vector<Point> lows, highs;
+    for (int i = 0; i != 200; ++i){
+        const Point corner = points[static_cast<size_t>(i) * 97];
+        lows.push_back({corner.x - 50, corner.y - 2000});
+        highs.push_back({corner.x + 10 * (i % 7), corner.y + 1000 * (i % 5)});
+    }
+    const vector<size_t> counts = batch.count_range_batch(lows.begin(), highs.begin(), lows.size());
+    vector<vector<const Point*>> inBoxes(lows.size());
+    batch.for_range_batch(lows.begin(), highs.begin(), lows.size(), [&](size_t box, Point& e){ inBoxes[box].push_back(&e); });
+    isSame = true;
+    for (size_t box = 0; box != lows.size(); ++box){
+        vector<const Point*> expected;
+        batch.for_range(lows[box], highs[box], [&](Point& e){ expected.push_back(&e); });
+        sort(expected.begin(), expected.end());
+        sort(inBoxes[box].begin(), inBoxes[box].end());
+        isSame &= (counts[box] == batch.count_range(lows[box], highs[box]) && inBoxes[box] == expected);
+    }
+    check(isSame, "for_range_batch and count_range_batch find the elements of each box");
+
+    TreeT rebalanced;
+    rebalanced.set_rebalancing();
+    rebalanced.push_batch(points.begin(), points.size());
+    check(rebalanced.get_nodeCnt() == points.size() && rebalanced.get_height() < 40, "push_batch with rebalancing");
+}
+
+struct Point16 {
+    int v[16];
+};
+
+struct ComparePoint16 {
+    static constexpr uint_fast8_t PROPERTIES_CNT = 16;
+
+    static uint_fast64_t get_Index(const Point16& lhs, const Point16& rhs) {
+        uint_fast64_t index = 0;
+        for (size_t i = 0; i != PROPERTIES_CNT; ++i){
+            index |= static_cast<uint_fast64_t>(lhs.v[i] > rhs.v[i]) << i;
+        }
+        return index;
+    }
+
+    static bool is_bigger(uint_fast8_t property, const Point16& lhs, const Point16& rhs) {
+        return lhs.v[property] > rhs.v[property];
+    }
+};
+
+template<typename NodeT>
+static bool is_valid16(const NodeT* node, size_t& nodeCnt) {
+    ++nodeCnt;
+    for (size_t pos = 0; pos != node->get_childEnd(); ++pos){
+        const NodeT* const child = node->get_childAt(pos);
+        if (child && (ComparePoint16::get_Index(**node, **child) != node->get_bucketAt(pos) || child->parent != node || !is_valid16(child, nodeCnt))){
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+    16 properties make 65536 buckets: make_Balanced and the rebuilds of removals and rebalancing only visit the buckets, that are used.
+    the points are clustered on few values, so that many of them share buckets and the recursion of the builds gets deep.
+*/
+static void test_highDimensions() {
+    vector<Point16> points(20000);
+    uint_fast32_t state = 12345;
+    for (size_t pos = 0; pos != points.size(); ++pos){
+        for (size_t i = 0; i != 15; ++i){ // only 2 properties differ, so that make_Balanced halves a subtree only every few levels
+            state = state * 1664525u + 1013904223u;
+            points[pos].v[i] = (i < 2)? static_cast<int>((state >> 16) % 3) : 0;
+        }
+        points[pos].v[15] = static_cast<int>(pos);
+    }
+    using Tree16 = KozyLibrary::Basic_K_Tree<Point16, ComparePoint16>;
+
+    Tree16 balanced = Tree16::make_Balanced(points.begin(), points.size());
+    size_t nodeCnt = 0;
+    check(is_valid16(balanced.get_root(), nodeCnt) && nodeCnt == points.size(), "make_Balanced with 16 properties");
+
+    bool isRemoved = true;
+    for (size_t pos = 0; pos < points.size(); pos += 2){
+        isRemoved &= (balanced.remove_element(points[pos]) == &points[pos]);
+    }
+    nodeCnt = 0;
+    check(isRemoved && is_valid16(balanced.get_root(), nodeCnt) && nodeCnt == points.size() / 2, "removals rebuild subtrees with 16 properties");
+
+    Tree16 rebalanced;
+    rebalanced.set_rebalancing(0.7);
+    for (auto& e : points){
+        rebalanced.push(e);
+    }
+    nodeCnt = 0;
+    check(is_valid16(rebalanced.get_root(), nodeCnt) && nodeCnt == points.size(), "rebalancing pushes with 16 properties");
+}
+
+/*
+prints one line per test, ends with:
+
+K_Tree test is successful!
+*/
+int main(int argc, const char** args) {
+    test_arena();
+    test_iterator();
+    test_range();
+    test_nearest();
+    test_balanced();
+    test_sparse();
+    test_remove<PointTree>("dense nodes");
+    test_remove<SparsePointTree>("sparse nodes");
+    test_rebalancing();
+    test_comparison();
+    test_highDimensions();
+    test_remove<KozyLibrary::Basic_K_Tree<Point, KozyLibrary::K_TreeProjections<&Point::x, &Point::y>, KozyLibrary::K_TreeChildren::sparse, KozyLibrary::K_TreeCopyKey>>("sparse nodes with cached keys");
+    test_keyCache();
+    test_concurrent();
+    test_batch<PointTree>("batches with dense nodes");
+    test_batch<SparsePointTree>("batches with sparse nodes");
+    test_batch<KozyLibrary::Basic_K_Tree<Point, KozyLibrary::K_TreeProjections<&Point::x, &Point::y>, KozyLibrary::K_TreeChildren::dense, KozyLibrary::K_TreeCopyKey>>("batches with cached keys");
+
+    if (failures != 0){
+        cout << failures << " K_Tree test(s) failed!" << endl;
+        return 1;
+    }
+    cout << "K_Tree test is successful!" << endl;
+    return 0;
+}
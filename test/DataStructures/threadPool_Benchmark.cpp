@@ -0,0 +1,387 @@
+#include "DataStructures/ThreadPool.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <future>
+#include <memory>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+using KozyLibrary::ThreadPool;
+
+
+/*
+    counts every heap allocation of the process.
+    the single object, the array and the aligned forms are replaced together, so that every delete matches its new.
+*/
+static atomic<uint_fast64_t> allocationCnt{0};
+
+static void* allocate(size_t sz) {
+    ++allocationCnt;
+    if (void* ptr = malloc(sz ? sz : 1)){
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+static void* allocate(size_t sz, align_val_t al) {
+    ++allocationCnt;
+    const size_t alignment = static_cast<size_t>(al);
+    const size_t alignedSize = sz ? (sz + alignment - 1) / alignment * alignment : alignment; // aligned_alloc only takes multiples of the alignment
+    if (void* ptr = aligned_alloc(alignment, alignedSize)){
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void* operator new(size_t sz) {
+    return allocate(sz);
+}
+void* operator new[](size_t sz) {
+    return allocate(sz);
+}
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+void* operator new(size_t sz, align_val_t al) {
+    return allocate(sz, al);
+}
+void* operator new[](size_t sz, align_val_t al) {
+    return allocate(sz, al);
+}
+void operator delete(void* ptr, align_val_t) noexcept {
+    free(ptr);
+}
+void operator delete[](void* ptr, align_val_t) noexcept {
+    free(ptr);
+}
+void operator delete(void* ptr, size_t, align_val_t) noexcept {
+    free(ptr);
+}
+void operator delete[](void* ptr, size_t, align_val_t) noexcept {
+    free(ptr);
+}
+
+
+struct Result {
+    double nsPerTask;
+    double allocationsPerTask;
+};
+
+template<typename BenchmarkT>
+static Result measure(uint_fast32_t taskCnt, BenchmarkT&& benchmark) {
+    const uint_fast64_t allocationsBefore = allocationCnt;
+    const auto begin = chrono::steady_clock::now();
+
+    benchmark();
+
+    const auto end = chrono::steady_clock::now();
+    return Result{
+        static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(end - begin).count()) / taskCnt,
+        static_cast<double>(allocationCnt - allocationsBefore) / taskCnt
+    };
+}
+
+static void print(const char* name, const Result& res) {
+    cout << name << ":\t" << res.nsPerTask << " ns/task\t" << res.allocationsPerTask << " allocations/task\n";
+}
+
+
+/*
+    compares the result-returning paths of ThreadPool:
+    add_Workload with a std::promise, the way it had to be done before submit() existed,
+    against submit() with its Future.
+
+    each task captures 40 bytes, which is more than std::function stores without an allocation.
+*/
+static bool benchmark_submit() {
+    static constexpr uint_fast32_t TASK_CNT = 200000;
+    static constexpr uint_fast32_t ROUNDS = 5;
+
+    ThreadPool pool;
+    pool.start();
+
+    uint_fast64_t capture[5] = {1, 2, 3, 4, 5};
+    uint_fast64_t checksum[2] = {0, 0};
+
+    vector<future<uint_fast64_t>> stdFutures;
+    vector<ThreadPool::Future<uint_fast64_t>> poolFutures;
+    stdFutures.reserve(TASK_CNT);
+    poolFutures.reserve(TASK_CNT);
+
+    cout << "workers: " << pool.get_workerCnt() << ", tasks per round: " << TASK_CNT << '\n';
+
+    for (uint_fast32_t round = 0; round != ROUNDS; ++round){
+        print("add_Workload + std::promise", measure(TASK_CNT, [&](){
+            for (uint_fast32_t i = 0; i != TASK_CNT; ++i){
+                auto promise = make_shared<std::promise<uint_fast64_t>>();
+                stdFutures.emplace_back(promise->get_future());
+                pool.add_Workload([promise, capture, i](){
+                    promise->set_value(capture[i % 5] + i);
+                });
+            }
+            for (auto& e : stdFutures){
+                checksum[0] += e.get();
+            }
+            stdFutures.clear();
+        }));
+
+        print("submit + ThreadPool::Future  ", measure(TASK_CNT, [&](){
+            for (uint_fast32_t i = 0; i != TASK_CNT; ++i){
+                poolFutures.emplace_back(pool.submit([capture, i](){
+                    return capture[i % 5] + i;
+                }));
+            }
+            for (auto& e : poolFutures){
+                checksum[1] += e.get();
+            }
+            poolFutures.clear();
+        }));
+    }
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    cout << ((checksum[0] == checksum[1])? "results are equal" : "RESULTS DIFFER") << "\n\n";
+    return checksum[0] == checksum[1];
+}
+
+
+/*
+    compares a fan-out of many small tasks with add_Workload in a loop against one call of add_Workloads,
+    until the pool is idle again.
+*/
+static void benchmark_bulk() {
+    static constexpr uint_fast32_t TASK_CNT = 100000;
+    static constexpr uint_fast32_t ROUNDS = 3;
+
+    ThreadPool pool;
+    pool.start();
+    atomic<uint_fast64_t> cnt{0};
+    const auto task = [&cnt](){ cnt.fetch_add(1, memory_order_relaxed); };
+
+    for (uint_fast32_t round = 0; round != ROUNDS; ++round){
+        print("add_Workload in a loop", measure(TASK_CNT, [&](){
+            for (uint_fast32_t i = 0; i != TASK_CNT; ++i){
+                pool.add_Workload(task);
+            }
+            pool.wait_idle();
+        }));
+
+        vector<ThreadPool::voidFunc> work(TASK_CNT, task);
+        print("add_Workloads         ", measure(TASK_CNT, [&](){
+            pool.add_Workloads(std::move(work));
+            pool.wait_idle();
+        }));
+    }
+
+    pool.stop();
+    pool.wait_untilStopped();
+    cout << '\n';
+}
+
+/*
+    measures how submission scales with the number of producers:
+    1 to N threads add tiny work through the submission queue at the same time, until the pool is idle again.
+*/
+static void benchmark_producers() {
+    static constexpr uint_fast32_t TASK_CNT = 400000;
+    const uint_fast32_t maxProducerCnt = (thread::hardware_concurrency() > 4)? thread::hardware_concurrency() : 4;
+
+    ThreadPool pool;
+    pool.start();
+    atomic<uint_fast64_t> cnt{0};
+
+    cout << "producer scaling, " << TASK_CNT << " tasks per round, submission capacity " << pool.get_submissionCapacity() << '\n';
+    for (uint_fast32_t producerCnt = 1; producerCnt <= maxProducerCnt; producerCnt *= 2){
+        const auto begin = chrono::steady_clock::now();
+
+        vector<thread> producer;
+        for (uint_fast32_t p = 0; p != producerCnt; ++p){
+            producer.emplace_back([&pool, &cnt, producerCnt](){
+                for (uint_fast32_t i = 0; i != TASK_CNT / producerCnt; ++i){
+                    pool.add_Workload([&cnt](){ cnt.fetch_add(1, memory_order_relaxed); });
+                }
+            });
+        }
+        for (auto& e : producer){
+            e.join();
+        }
+        pool.wait_idle();
+
+        const auto end = chrono::steady_clock::now();
+        cout << producerCnt << " producer(s):\t" 
+            << static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(end - begin).count()) / TASK_CNT << " ns/task\n";
+    }
+
+    pool.stop();
+    pool.wait_untilStopped();
+    cout << '\n';
+}
+
+
+/*
+    measures the submit-to-start latency of probes while the pool is saturated with background work:
+    probes in the high lane against probes in the normal lane behind the same background work.
+*/
+static void benchmark_priorities() {
+    static constexpr uint_fast32_t BACKGROUND_CNT = 100000;
+    static constexpr uint_fast32_t PROBE_CNT = 200;
+
+    for (auto priority : {ThreadPool::Priority::high, ThreadPool::Priority::normal}){
+        ThreadPool pool;
+        pool.start();
+
+        const auto background = [](){
+            const auto until = chrono::steady_clock::now() + chrono::microseconds(2);
+            while (chrono::steady_clock::now() < until){
+
+            }
+        };
+        thread flooder([&pool, &background](){
+            for (uint_fast32_t i = 0; i != BACKGROUND_CNT; ++i){
+                pool.add_Workload(background);
+            }
+        });
+
+        vector<chrono::nanoseconds> latency(PROBE_CNT);
+        for (uint_fast32_t probe = 0; probe != PROBE_CNT; ++probe){
+            this_thread::sleep_for(chrono::microseconds(200));
+            atomic<bool> started{false};
+            const auto submitTime = chrono::steady_clock::now();
+            pool.add_Workload([&latency, &started, submitTime, probe](){
+                latency[probe] = chrono::steady_clock::now() - submitTime;
+                started = true;
+                started.notify_one();
+            }, priority);
+            started.wait(false);
+        }
+        flooder.join();
+
+        sort(latency.begin(), latency.end());
+        cout << ((priority == ThreadPool::Priority::high)? "high probes  " : "normal probes") << ":\tp50 "
+            << static_cast<double>(latency[PROBE_CNT / 2].count()) / 1000 << " us\tp99 "
+            << static_cast<double>(latency[PROBE_CNT * 99 / 100].count()) / 1000 << " us\tpeak normal depth "
+            << pool.get_peakQueueDepth(ThreadPool::Priority::normal) << '\n';
+
+        pool.stop();
+        pool.wait_untilStopped();
+    }
+    cout << '\n';
+}
+
+/*
+    the cost of inserting and cancelling timers while many are pending, and how late timers fire on a parked pool.
+*/
+static void benchmark_timers() {
+    static constexpr uint_fast32_t TIMER_CNT = 50000;
+    static constexpr uint_fast32_t PROBE_CNT = 200;
+
+    ThreadPool pool;
+    pool.set_idleStrategy(ThreadPool::IdleStrategy::parking);
+    pool.start();
+
+    vector<ThreadPool::Timer> timers;
+    timers.reserve(TIMER_CNT);
+    auto begin = chrono::steady_clock::now();
+    for (uint_fast32_t i = 0; i != TIMER_CNT; ++i){
+        timers.push_back(pool.schedule_after(chrono::seconds(10) + chrono::milliseconds(i % 5000), [](){}));
+    }
+    const auto insertTime = chrono::steady_clock::now() - begin;
+    begin = chrono::steady_clock::now();
+    for (auto& e : timers){
+        e.cancel();
+    }
+    const auto cancelTime = chrono::steady_clock::now() - begin;
+
+    vector<chrono::nanoseconds> lateness(PROBE_CNT);
+    for (uint_fast32_t probe = 0; probe != PROBE_CNT; ++probe){
+        atomic<bool> fired{false};
+        const auto due = chrono::steady_clock::now() + chrono::microseconds(1500);
+        pool.schedule_after(chrono::microseconds(1500), [&lateness, &fired, due, probe](){
+            lateness[probe] = chrono::steady_clock::now() - due;
+            fired = true;
+            fired.notify_one();
+        });
+        fired.wait(false);
+    }
+    sort(lateness.begin(), lateness.end());
+
+    cout << "timers:\tinsert " << static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(insertTime).count()) / TIMER_CNT 
+        << " ns\tcancel " << static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(cancelTime).count()) / TIMER_CNT 
+        << " ns\tlateness p50 " << static_cast<double>(lateness[PROBE_CNT / 2].count()) / 1000 
+        << " us\tp99 " << static_cast<double>(lateness[PROBE_CNT * 99 / 100].count()) / 1000 << " us\n\n";
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    compares the idle strategies of ThreadPool:
+    the CPU time an idle pool burns and the time from add_Workload until the work starts, if the workers are idle.
+*/
+static void benchmark_idle(ThreadPool::IdleStrategy strategy, const char* name) {
+    static constexpr uint_fast32_t LATENCY_ROUNDS = 2000;
+
+    ThreadPool pool;
+    pool.set_idleStrategy(strategy);
+    pool.start();
+    this_thread::sleep_for(chrono::milliseconds(10));
+
+    const clock_t cpuBefore = clock();
+    this_thread::sleep_for(chrono::milliseconds(300));
+    const double idleCpu = static_cast<double>(clock() - cpuBefore) / CLOCKS_PER_SEC / 0.3;
+
+    chrono::nanoseconds latency{0};
+    for (uint_fast32_t round = 0; round != LATENCY_ROUNDS; ++round){
+        this_thread::sleep_for(chrono::microseconds(50)); // lets the workers become idle
+
+        atomic<bool> started{false};
+        chrono::steady_clock::time_point startTime;
+        const auto submitTime = chrono::steady_clock::now();
+        pool.add_Workload([&started, &startTime](){
+            startTime = chrono::steady_clock::now();
+            started = true;
+            started.notify_one();
+        });
+        started.wait(false);
+        latency += startTime - submitTime;
+    }
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    cout << name << ":\tidle CPU " << idleCpu * 100 << "% of a core\tsubmit-to-start " 
+        << static_cast<double>(latency.count()) / LATENCY_ROUNDS / 1000 << " us\n";
+}
+
+
+int main(int argc, const char** args) {
+    const bool success = benchmark_submit();
+    benchmark_bulk();
+    benchmark_producers();
+    benchmark_priorities();
+    benchmark_timers();
+
+    benchmark_idle(ThreadPool::IdleStrategy::pausingWork, "pausingWork");
+    benchmark_idle(ThreadPool::IdleStrategy::parking, "parking    ");
+
+    cout << endl;
+    return success? 0 : 1;
+}
@@ -0,0 +1,902 @@
+#define KOZYLIBRARY_THREADPOOL_STATS // the test checks the stats as well
+#include "DataStructures/ThreadPool.hpp"
+#include "DataStructures/TaskGraph.hpp"
+#include "DataStructures/ThreadPool_Coroutine.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <future>
+#include <thread>
+#include <numeric>
+#include <mutex>
+#include <algorithm>
+
+using namespace std;
+using KozyLibrary::ThreadPool;
+using KozyLibrary::TaskGraph;
+using KozyLibrary::Task;
+
+
+static int failures = 0;
+
+static void check(bool condition, const char* name) {
+    cout << (condition? "passed: " : "FAILED: ") << name << endl;
+    if (!condition){
+        ++failures;
+    }
+}
+
+/*
+    work that is added before start() is processed once the workers exist.
+*/
+static void test_addBeforeStart() {
+    ThreadPool pool;
+    atomic<uint_fast32_t> cnt{0};
+
+    for (int i = 0; i != 1000; ++i){
+        pool.add_Workload([&cnt](){ ++cnt; });
+    }
+    pool.start(4);
+    pool.stop();
+    pool.wait_untilStopped();
+
+    check(cnt == 1000, "work added before start is processed");
+}
+
+/*
+    many small tasks, from several producers, spread across all worker queues and get stolen.
+*/
+static void test_manySmallTasks() {
+    ThreadPool pool;
+    atomic<uint_fast32_t> cnt{0};
+    pool.start(4);
+
+    thread producer[3];
+    for (auto& e : producer){
+        e = thread([&pool, &cnt](){
+            for (int i = 0; i != 20000; ++i){
+                pool.add_Workload([&cnt](){ ++cnt; });
+            }
+        });
+    }
+    for (auto& e : producer){
+        e.join();
+    }
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    check(cnt == 60000, "all tasks of all producers are processed");
+}
+
+/*
+    a task that adds work pushes into the queue of its own worker.
+*/
+static void test_nestedWork() {
+    ThreadPool pool;
+    atomic<uint_fast32_t> cnt{0};
+    pool.start(2);
+
+    for (int i = 0; i != 100; ++i){
+        pool.add_Workload([&pool, &cnt](){
+            for (int j = 0; j != 10; ++j){
+                pool.add_Workload([&cnt](){ ++cnt; });
+            }
+        });
+    }
+
+    pool.restart(3);
+    pool.stop();
+    pool.wait_untilStopped();
+
+    check(cnt == 1000, "work added by work is processed");
+}
+
+/*
+    no work is processed while paused.
+*/
+static void test_pause() {
+    ThreadPool pool;
+    atomic<uint_fast32_t> cnt{0};
+    pool.start(2);
+
+    pool.pause();
+    pool.wait_untilPaused();
+    for (int i = 0; i != 100; ++i){
+        pool.add_Workload([&cnt](){ ++cnt; });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const bool nothingDone = (cnt == 0);
+    pool.unpause();
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    check(nothingDone && cnt == 100, "paused pool processes no work until unpaused");
+}
+
+/*
+    submit() returns the result, forwards exceptions and may be waited on inside of work.
+*/
+static void test_submit() {
+    ThreadPool pool;
+    pool.start(3);
+
+    vector<ThreadPool::Future<uint_fast64_t>> results;
+    for (uint_fast64_t i = 0; i != 1000; ++i){
+        results.emplace_back(pool.submit([](uint_fast64_t a, uint_fast64_t b){ return a * b; }, i, i));
+    }
+    uint_fast64_t sum = 0;
+    for (auto& e : results){
+        sum += e.get();
+    }
+    check(sum == 332833500, "submit returns the results");
+
+    auto str = pool.submit([](string s){ return s + " world"; }, string("hello"));
+    check(str.get() == "hello world", "submit forwards arguments by value");
+
+    auto fail = pool.submit([](){ throw runtime_error("expected"); });
+    bool thrown = false;
+    try {
+        fail.get();
+    } catch (const runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "submit forwards exceptions");
+
+    auto outer = pool.submit([&pool](){
+        auto inner = pool.submit([](){ return 21; });
+        return inner.get() * 2;
+    });
+    check(outer.get() == 42, "waiting on a Future inside of work");
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    work that never runs breaks its promise.
+*/
+static void test_brokenPromise() {
+    ThreadPool::Future<int> orphan;
+    {
+        ThreadPool pool;
+        orphan = pool.submit([](){ return 1; });
+    }
+
+    bool broken = false;
+    try {
+        orphan.get();
+    } catch (const future_error& e) {
+        broken = (e.code() == future_errc::broken_promise);
+    }
+    check(broken, "a Future of work that never ran outlives its ThreadPool");
+}
+
+/*
+    parked workers wake up for new work, for pause() and for stop().
+*/
+static void test_parking() {
+    ThreadPool pool;
+    atomic<uint_fast32_t> cnt{0};
+    pool.set_idleStrategy(ThreadPool::IdleStrategy::parking);
+    pool.start(3);
+
+    for (int round = 0; round != 50; ++round){
+        std::this_thread::sleep_for(std::chrono::microseconds(200)); // workers are parked by now
+        auto res = pool.submit([&cnt](){ return ++cnt; });
+        res.get();
+    }
+    const bool allWoken = (cnt == 50);
+
+    pool.pause();
+    pool.wait_untilPaused();
+    pool.add_Workload([&cnt](){ ++cnt; });
+    const bool pausedWhileParked = (cnt == 50);
+    pool.unpause();
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    check(allWoken && pausedWhileParked && cnt == 51, "parked workers wake up for work, pause and stop");
+}
+
+/*
+    parallel_for, parallel_reduce and parallel_transform over index and iterator ranges, 
+    with automatic and explicit grain sizes, on a running, a paused and a not running pool.
+*/
+static void test_parallelAlgorithms() {
+    ThreadPool pool;
+    pool.start(3);
+
+    vector<uint_fast64_t> values(100000);
+    pool.parallel_for(size_t(0), values.size(), [&values](size_t i){ values[i] = i; });
+    check(values[99999] == 99999 && values[12345] == 12345, "parallel_for over indices");
+
+    pool.parallel_for(values.begin(), values.end(), [](uint_fast64_t& e){ e *= 2; }, 7);
+    check(values[99999] == 199998, "parallel_for over iterators with a grain size");
+
+    const uint_fast64_t sum = pool.parallel_reduce(values.begin(), values.end(), uint_fast64_t(0), std::plus<>{});
+    check(sum == 99999ull * 100000ull, "parallel_reduce");
+
+    const string joined = pool.parallel_reduce(0, 10, string(">"), std::plus<>{}, [](int i){ return to_string(i); }, 1);
+    check(joined == ">0123456789", "parallel_reduce keeps the order of a non commutative reduction");
+
+    const long grainedSum = pool.parallel_reduce(0L, 1000L, 0L, std::plus<>{}, 16);
+    check(grainedSum == 999L * 1000L / 2, "parallel_reduce with a grain size and without a transform");
+
+    vector<uint_fast64_t> squares(1000);
+    pool.parallel_transform(values.begin(), values.begin() + 1000, squares.begin(), [](uint_fast64_t e){ return e * e; });
+    check(squares[999] == 1998ull * 1998ull, "parallel_transform");
+
+    atomic<uint_fast32_t> inner{0};
+    pool.parallel_for(0, 16, [&pool, &inner](int){
+        pool.parallel_for(0, 100, [&inner](int){ ++inner; });
+    }, 1);
+    check(inner == 1600, "nested parallel_for");
+
+    bool thrown = false;
+    try {
+        pool.parallel_for(0, 1000, [](int i){ if (i == 500) throw runtime_error("expected"); });
+    } catch (const runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "parallel_for forwards exceptions");
+
+    pool.pause();
+    pool.wait_untilPaused();
+    const int pausedSum = pool.parallel_reduce(1, 101, 0, std::plus<>{});
+    pool.unpause();
+    check(pausedSum == 5050, "the calling thread finishes the range on its own if the pool is paused");
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    const int stoppedSum = pool.parallel_reduce(1, 101, 0, std::plus<>{});
+    check(stoppedSum == 5050, "the calling thread finishes the range on its own if the pool is not running");
+}
+
+/*
+    a TaskGroup waits for exactly its own work, wait_idle() for all work, and the workers survive both.
+*/
+static void test_taskGroup() {
+    ThreadPool pool;
+    pool.start(3);
+
+    atomic<bool> release{false}, blocking{false};
+    pool.add_Workload([&release, &blocking](){ // blocks one worker until the end of the test
+        blocking = true;
+        while (!release){
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+    while (!blocking){
+        std::this_thread::yield();
+    }
+
+    bool allGroupsDone = true;
+    for (int batch = 0; batch != 20; ++batch){
+        ThreadPool::TaskGroup group(pool);
+        atomic<uint_fast32_t> cnt{0};
+        for (int i = 0; i != 100; ++i){
+            group.run([&group, &cnt](){
+                ++cnt;
+                group.run([&cnt](){ ++cnt; });
+            });
+        }
+        group.wait();
+        allGroupsDone = allGroupsDone && (cnt == 200);
+    }
+    check(allGroupsDone && !release, "TaskGroup::wait only waits for the work of its group");
+
+    ThreadPool::TaskGroup failing(pool);
+    failing.run([](){ throw runtime_error("expected"); });
+    failing.run([](){});
+    bool thrown = false;
+    try {
+        failing.wait();
+    } catch (const runtime_error&) {
+        thrown = true;
+    }
+    check(thrown && failing.is_done(), "TaskGroup::wait forwards exceptions");
+
+    release = true;
+    atomic<uint_fast32_t> cnt{0};
+    for (int i = 0; i != 1000; ++i){
+        pool.add_Workload([&pool, &cnt](){
+            pool.add_Workload([&cnt](){ ++cnt; });
+        });
+    }
+    pool.wait_idle();
+    const bool idle = (cnt == 1000) && pool.is_idle() && pool.is_running();
+
+    pool.add_Workload([&cnt](){ ++cnt; });
+    pool.wait_idle();
+    check(idle && cnt == 1001, "wait_idle waits for all work and keeps the workers");
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    a full submission queue rejects, or blocks the producer until the workers took work out of it.
+*/
+static void test_backpressure() {
+    atomic<uint_fast32_t> cnt{0};
+    {
+        ThreadPool pool(4, ThreadPool::Backpressure::reject);
+        pool.start(2);
+        pool.pause();
+        pool.wait_untilPaused();
+
+        uint_fast32_t acceptedCnt = 0;
+        for (int i = 0; i != 10; ++i){
+            acceptedCnt += pool.add_Workload([&cnt](){ ++cnt; });
+        }
+        auto rejected = pool.submit([](){ return 1; });
+        bool broken = false;
+        try {
+            rejected.get();
+        } catch (const future_error& e) {
+            broken = (e.code() == future_errc::broken_promise);
+        }
+        pool.unpause();
+        pool.wait_idle();
+        check(pool.get_submissionCapacity() == 4 && acceptedCnt == 4 && cnt == 4 && broken, "a full submission queue rejects work");
+    }
+
+    for (auto policy : {ThreadPool::Backpressure::block, ThreadPool::Backpressure::spin}){
+        cnt = 0;
+        ThreadPool pool(3, policy);
+        pool.start(2);
+        pool.pause();
+        pool.wait_untilPaused();
+
+        atomic<bool> produced{false};
+        thread producer([&pool, &cnt, &produced](){
+            for (int i = 0; i != 1000; ++i){
+                pool.add_Workload([&cnt](){ ++cnt; });
+            }
+            produced = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const bool waited = !produced && cnt == 0;
+        pool.unpause();
+        producer.join();
+        pool.wait_idle();
+        check(waited && cnt == 1000, (policy == ThreadPool::Backpressure::block)? 
+            "a full submission queue blocks the producer" : "a full submission queue lets the producer spin");
+    }
+}
+
+/*
+    add_Workloads adds whole ranges before start, from other threads, from workers and into a small submission queue.
+*/
+static void test_bulkSubmission() {
+    atomic<uint_fast32_t> cnt{0};
+    const auto inc = [&cnt](){ ++cnt; };
+
+    ThreadPool pool{inc, inc, inc};
+    vector<ThreadPool::voidFunc> work(10000, inc);
+    check(pool.add_Workloads(std::move(work)) == 10000 && work.empty(), "add_Workloads moves a vector before start");
+    pool.start(3);
+    pool.wait_idle();
+    check(cnt == 10003, "work of the constructor and of add_Workloads is processed");
+
+    cnt = 0;
+    vector<ThreadPool::voidFunc> big(100000, inc);
+    thread producer[2];
+    for (auto& e : producer){
+        e = thread([&pool, &inc](){
+            vector<ThreadPool::voidFunc> own(50000, inc);
+            pool.add_Workloads(own.begin(), own.end());
+        });
+    }
+    pool.add_Workloads(big.begin(), big.end());
+    for (auto& e : producer){
+        e.join();
+    }
+    pool.add_Workload([&pool, &inc](){
+        pool.add_Workloads({inc, inc, inc, inc, inc});
+    });
+    pool.wait_idle();
+    check(cnt == 200005, "add_Workloads from several threads and from a worker");
+    pool.stop();
+    pool.wait_untilStopped();
+
+    cnt = 0;
+    ThreadPool small(16, ThreadPool::Backpressure::reject);
+    small.start(2);
+    small.pause();
+    small.wait_untilPaused();
+    vector<ThreadPool::voidFunc> tooMuch(100, inc);
+    const std::size_t addedCnt = small.add_Workloads(tooMuch.begin(), tooMuch.end());
+    small.unpause();
+    small.wait_idle();
+    check(addedCnt == 16 && cnt == 16, "add_Workloads stops at a full submission queue that rejects");
+
+    cnt = 0;
+    small.set_backpressure(ThreadPool::Backpressure::block);
+    vector<ThreadPool::voidFunc> again(100000, inc);
+    small.add_Workloads(again.begin(), again.end());
+    small.wait_idle();
+    check(cnt == 100000, "add_Workloads blocks at a full submission queue");
+}
+
+/*
+    a worker drains the high lane first, but the low lane ages and does not starve.
+*/
+static void test_priorities() {
+    using Priority = ThreadPool::Priority;
+
+    ThreadPool pool;
+    pool.start(1); // one worker, so that the order is deterministic
+    pool.pause();
+    pool.wait_untilPaused();
+
+    vector<Priority> order;
+    mutex orderGuard;
+    const auto record = [&order, &orderGuard](Priority priority){
+        return [&order, &orderGuard, priority](){
+            lock_guard lock(orderGuard);
+            order.push_back(priority);
+        };
+    };
+    for (int i = 0; i != 100; ++i){
+        pool.add_Workload(record(Priority::low), Priority::low);
+        pool.add_Workload(record(Priority::normal));
+    }
+    for (int i = 0; i != 5; ++i){
+        pool.add_Workload(record(Priority::high), Priority::high);
+    }
+    auto highResult = pool.submit(Priority::high, [](int a){ return a + 1; }, 41);
+
+    const bool depthCounted = pool.get_queueDepth(Priority::high) == 6 && pool.get_queueDepth(Priority::normal) == 100 
+        && pool.get_queueDepth(Priority::low) == 100 && pool.get_peakQueueDepth(Priority::low) == 100;
+    pool.unpause();
+    for (bool done = false; !done; ){ // waits without helping, so that only the worker takes work
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        lock_guard lock(orderGuard);
+        done = (order.size() == 205);
+    }
+
+    bool highFirst = order.size() == 205;
+    for (int i = 0; i != 5 && highFirst; ++i){
+        highFirst = (order[i] == Priority::high);
+    }
+    std::size_t firstLow = 0;
+    while (firstLow != order.size() && order[firstLow] != Priority::low){
+        ++firstLow;
+    }
+    std::size_t lastNormal = order.size();
+    while (lastNormal != 0 && order[lastNormal - 1] != Priority::normal){
+        --lastNormal;
+    }
+
+    check(depthCounted && pool.get_queueDepth(Priority::low) == 0, "each lane counts its queue depth");
+    check(highFirst && highResult.get() == 42, "high lane is drained first");
+    check(firstLow < lastNormal, "low lane ages and runs before the normal lane is empty");
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    coroutines hop onto the workers with schedule(), await each other as Tasks and are awaited together with when_all.
+    without running workers, they stay on the awaiting thread.
+*/
+static Task<uint_fast64_t> square_onPool(ThreadPool& pool, uint_fast64_t value, thread::id caller, atomic<bool>& onWorker) {
+    co_await pool.schedule();
+    if (this_thread::get_id() == caller){
+        onWorker = false;
+    }
+    co_return value * value;
+}
+
+static Task<void> fail_onPool(ThreadPool& pool) {
+    co_await pool.schedule(ThreadPool::Priority::high);
+    throw runtime_error("expected");
+}
+
+static Task<uint_fast64_t> sum_ofSquares(ThreadPool& pool, uint_fast64_t cnt, thread::id caller, atomic<bool>& onWorker) {
+    vector<Task<uint_fast64_t>> squares;
+    for (uint_fast64_t i = 0; i != cnt; ++i){
+        squares.emplace_back(square_onPool(pool, i, caller, onWorker));
+    }
+    const vector<uint_fast64_t> res = co_await KozyLibrary::when_all(std::move(squares));
+
+    uint_fast64_t sum = 0;
+    for (auto e : res){
+        sum += e;
+    }
+    co_return sum;
+}
+
+static Task<string> combine(ThreadPool& pool, thread::id caller, atomic<bool>& onWorker) {
+    auto [a, b, none] = co_await KozyLibrary::when_all(
+        square_onPool(pool, 3, caller, onWorker), 
+        sum_ofSquares(pool, 10, caller, onWorker), 
+        [](ThreadPool& p) -> Task<void> { co_await p.schedule(); }(pool)
+    );
+    co_return to_string(a) + "," + to_string(b);
+}
+
+static void test_coroutines() {
+    ThreadPool pool;
+    pool.start(3);
+    atomic<bool> onWorker{true};
+    const thread::id caller = this_thread::get_id();
+
+    check(KozyLibrary::sync_wait(square_onPool(pool, 12, caller, onWorker)) == 144 && onWorker, "a Task hops onto a worker with schedule()");
+    check(KozyLibrary::sync_wait(sum_ofSquares(pool, 1000, caller, onWorker)) == 332833500 && onWorker, "when_all over a vector of Tasks");
+    check(KozyLibrary::sync_wait(combine(pool, caller, onWorker)) == "9,285", "when_all over different Tasks");
+
+    bool thrown = false;
+    try {
+        vector<Task<void>> tasks;
+        tasks.emplace_back(fail_onPool(pool));
+        tasks.emplace_back([](ThreadPool& p) -> Task<void> { co_await p.schedule(); }(pool));
+        KozyLibrary::sync_wait(KozyLibrary::when_all(std::move(tasks)));
+    } catch (const runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "when_all forwards exceptions");
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    ThreadPool notStarted;
+    onWorker = true;
+    check(KozyLibrary::sync_wait(square_onPool(notStarted, 5, caller, onWorker)) == 25 && !onWorker,
+        "schedule() on a pool, that is not running, continues on the awaiting thread");
+}
+
+/*
+    every worker reports what it executed, where it took it from and how its time was spent.
+*/
+static void test_stats() {
+    ThreadPool pool;
+    pool.start(2);
+
+    for (int i = 0; i != 200; ++i){
+        pool.add_Workload([&pool](){
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            pool.add_Workload([](){});
+        });
+    }
+    for (bool done = false; !done; ){ // waits without helping, so that the workers execute everything
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        done = pool.is_idle();
+    }
+    pool.pause();
+    pool.wait_untilPaused();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pool.unpause();
+    for (auto id = pool.get_workerCnt(); id != 0; --id){
+        pool.submit([](){}).get(); // every worker left the pause, once it took work again
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    uint_fast64_t executedCnt = 0, takenCnt = 0, runCnt = 0, waitCnt = 0;
+    std::chrono::nanoseconds busyTime{0}, idleTime{0}, pausedTime{0};
+    for (const ThreadPool::WorkerStats& e : pool.get_stats()){
+        executedCnt += e.executedCnt;
+        takenCnt += e.localCnt + e.submittedCnt + e.stolenCnt;
+        for (std::size_t bucket = 0; bucket != ThreadPool::HISTOGRAM_SIZE; ++bucket){
+            runCnt += e.runHistogram[bucket];
+            waitCnt += e.waitHistogram[bucket];
+        }
+        busyTime += e.busyTime;
+        idleTime += e.idleTime;
+        pausedTime = std::max(pausedTime, e.pausedTime);
+    }
+
+    check(executedCnt >= 400 && takenCnt == executedCnt && runCnt == executedCnt && waitCnt == executedCnt, "stats count every executed work once");
+    check(busyTime >= std::chrono::microseconds(200 * 100) && idleTime > std::chrono::nanoseconds(0) 
+        && pausedTime >= std::chrono::milliseconds(15), "stats measure busy, idle and paused time");
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    workers run on the cpus of their placement and call onWorkerStart once each.
+*/
+static void test_placement() {
+    check(!ThreadPool::get_numaNodes().empty() && !ThreadPool::get_numaNodes()[0].empty(), "get_numaNodes finds the cpus");
+    check(ThreadPool::parse_cpuList("0-2,5,7-8") == vector<unsigned>{0, 1, 2, 5, 7, 8}, "parse_cpuList reads ranges");
+
+    ThreadPool pool;
+    pool.start(2);
+    atomic<int> startedCnt{0};
+    pool.set_placement({ThreadPool::PlacementPolicy::cpuSets, {{0}}, [&startedCnt](auto, unsigned){ ++startedCnt; }});
+
+    bool onFirstCpu = true;
+#ifdef __linux__
+    for (int i = 0; i != 20; ++i){
+        onFirstCpu = (pool.submit([](){ return sched_getcpu(); }).get() == 0) && onFirstCpu;
+    }
+#endif
+    check(onFirstCpu && startedCnt == static_cast<int>(pool.get_workerCnt()), "workers are pinned to their cpu set");
+
+    pool.set_placement({ThreadPool::PlacementPolicy::numaNodes, {}, {}});
+    atomic<int> sum{0};
+    for (int i = 0; i != 1000; ++i){
+        pool.add_Workload([&sum, &pool](){
+            pool.add_Workload([&sum](){ ++sum; });
+        });
+    }
+    pool.wait_idle();
+    check(sum == 1000 && pool.get_workerNode(0) < ThreadPool::get_numaNodes().size(), "workers placed on NUMA nodes process all work");
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    workers are added and retired while work keeps flowing, also during a pause, by autoscaling and during parallel_reduce.
+    on a machine with a single cpu, the ThreadPool can not grow beyond one worker.
+*/
+static void test_resize() {
+    const auto maxCnt = ThreadPool::MAX_THREADS;
+    ThreadPool pool;
+    pool.start(1);
+
+    atomic<int> sum{0};
+    atomic<bool> isProducing{true};
+    thread producer([&](){
+        while (isProducing){
+            pool.add_Workload([&sum](){ ++sum; });
+        }
+    });
+    check(pool.grow(3) == std::min<decltype(maxCnt)>(3, maxCnt - 1), "grow adds workers up to MAX_THREADS");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.shrink(2);
+    pool.grow(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const auto beforeCnt = pool.get_workerCnt();
+    check(pool.shrink(100) == beforeCnt - 1 && pool.get_workerCnt() == 1, "shrink keeps one worker");
+    isProducing = false;
+    producer.join();
+    pool.wait_idle();
+    const int produced = sum;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    mutex guard;
+    vector<std::thread::id> executors;
+    for (int i = 0; i != 200; ++i){
+        pool.add_Workload([&](){
+            lock_guard lock(guard);
+            executors.push_back(std::this_thread::get_id());
+        });
+    }
+    for (bool done = false; !done; ){ // waits without helping, so that only the workers execute
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        lock_guard lock(guard);
+        done = (executors.size() == 200);
+    }
+    sort(executors.begin(), executors.end());
+    check(produced > 0 && unique(executors.begin(), executors.end()) - executors.begin() == 1, "retired workers leave the work to the others");
+
+    pool.pause();
+    pool.wait_untilPaused();
+    pool.grow(2);
+    atomic<bool> ranWhilePaused{false};
+    pool.add_Workload([&ranWhilePaused](){ ranWhilePaused = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const bool wasPaused = pool.is_paused() && !ranWhilePaused;
+    pool.unpause();
+    pool.wait_idle();
+    pool.pause(); // counts the added workers
+    pool.wait_untilPaused();
+    pool.unpause();
+    check(wasPaused && ranWhilePaused, "workers added to a paused pool wait for unpause");
+
+    pool.shrink(pool.get_workerCnt());
+    pool.set_autoscaling({1, maxCnt, 4, std::chrono::milliseconds(20)});
+    for (int i = 0; i != 2000; ++i){
+        pool.add_Workload([](){ std::this_thread::sleep_for(std::chrono::microseconds(20)); });
+    }
+    auto peakCnt = pool.get_workerCnt();
+    for (bool done = false; !done; ){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        peakCnt = std::max(peakCnt, pool.get_workerCnt());
+        done = pool.is_idle();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    check((maxCnt == 1 || peakCnt > 1) && pool.get_workerCnt() == 1, "autoscaling grows with the queue depth and shrinks when idle");
+    pool.disable_autoscaling();
+
+    atomic<bool> isResizing{true};
+    thread resizer([&](){
+        while (isResizing){
+            pool.grow(3);
+            pool.shrink(3);
+        }
+    });
+    bool reducedAll = true;
+    for (int i = 0; i != 200; ++i){
+        reducedAll &= (pool.parallel_reduce(0L, 10000L, 0L, std::plus<>{}) == 9999L * 10000L / 2);
+    }
+    isResizing = false;
+    resizer.join();
+    check(reducedAll, "parallel_reduce while workers are added and retired");
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    timers run their work after their delay, periodic timers until they are cancelled, also on a parked pool.
+*/
+static void test_timers() {
+    using std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    ThreadPool pool;
+    pool.set_idleStrategy(ThreadPool::IdleStrategy::parking);
+    pool.start(2);
+
+    const auto begin = steady_clock::now();
+    atomic<int64_t> firedAfter{-1};
+    atomic<bool> firedAt{false}, cancelledRan{false};
+    pool.schedule_after(milliseconds(30), [&](){ 
+        firedAfter = std::chrono::duration_cast<milliseconds>(steady_clock::now() - begin).count(); 
+    });
+    pool.schedule_at(std::chrono::system_clock::now() + milliseconds(10), [&](){ firedAt = true; });
+    ThreadPool::Timer cancelled = pool.schedule_after(milliseconds(20), [&](){ cancelledRan = true; });
+    const bool isCancelled = cancelled.cancel();
+    const bool isCancelledTwice = cancelled.cancel();
+
+    atomic<int> ticks{0};
+    ThreadPool::Timer periodic = pool.schedule_every(milliseconds(5), [&](){ ++ticks; });
+
+    std::this_thread::sleep_for(milliseconds(100)); // the workers are parked until the timers expire
+    check(firedAfter >= 30 && firedAt && !cancelledRan && isCancelled && !isCancelledTwice, "timers run once after their delay, unless cancelled");
+
+    check(periodic.cancel() && ticks >= 5, "periodic timers repeat until cancelled");
+    pool.wait_idle();
+    const int ticksAtCancel = ticks;
+    std::this_thread::sleep_for(milliseconds(20));
+    check(ticks == ticksAtCancel && pool.get_timerCnt() == 0, "cancelled periodic timers stop");
+
+    constexpr int TIMER_CNT = 20000;
+    atomic<int> firedCnt{0}, earlyCnt{0};
+    vector<ThreadPool::Timer> handles;
+    handles.reserve(TIMER_CNT);
+    const auto start = steady_clock::now();
+    for (int i = 0; i != TIMER_CNT; ++i){
+        const auto delay = milliseconds(i % 97);
+        handles.push_back(pool.schedule_after(delay, [&, delay](){
+            ++firedCnt;
+            if (steady_clock::now() - start < delay){
+                ++earlyCnt;
+            }
+        }));
+    }
+    int cancelledCnt = 0;
+    for (int i = 0; i < TIMER_CNT; i += 3){
+        cancelledCnt += handles[i].cancel();
+    }
+    std::this_thread::sleep_for(milliseconds(150));
+    pool.wait_idle();
+    check(firedCnt + cancelledCnt == TIMER_CNT && earlyCnt == 0 && pool.get_timerCnt() == 0, "many timers fire no earlier than their delay");
+
+    pool.stop();
+    pool.wait_untilStopped();
+}
+
+/*
+    a TaskGraph starts each node after all of its predecessors, may run many times and forwards exceptions.
+*/
+static void test_taskGraph() {
+    ThreadPool pool;
+    pool.start(3);
+
+    // layers of 8 nodes, each node depends on two nodes of the layer before
+    static constexpr int LAYERS = 20, WIDTH = 8;
+    TaskGraph graph;
+    vector<atomic<uint_fast32_t>> runs(LAYERS * WIDTH);
+    atomic<bool> inOrder{true};
+    for (int layer = 0; layer != LAYERS; ++layer){
+        for (int i = 0; i != WIDTH; ++i){
+            const int id = layer * WIDTH + i;
+            graph.add_Node([&runs, &inOrder, id, layer, i](){
+                if (layer != 0){
+                    const uint_fast32_t own = runs[id].load();
+                    if (runs[id - WIDTH].load() != own + 1 || runs[(layer - 1) * WIDTH + (i + 1) % WIDTH].load() != own + 1){
+                        inOrder = false;
+                    }
+                }
+                ++runs[id];
+            });
+            if (layer != 0){
+                graph.add_Edge((layer - 1) * WIDTH + i, id);
+                graph.add_Edge((layer - 1) * WIDTH + (i + 1) % WIDTH, id);
+            }
+        }
+    }
+
+    for (int round = 0; round != 100; ++round){
+        graph.run(pool);
+    }
+    bool allRan = true;
+    for (auto& e : runs){
+        allRan = allRan && (e == 100);
+    }
+    check(allRan && inOrder, "TaskGraph runs each node after its predecessors, repeatedly");
+
+    pool.pause();
+    pool.wait_untilPaused();
+    graph.run(pool);
+    pool.unpause();
+    check(runs[0] == 101 && runs[LAYERS * WIDTH - 1] == 101 && inOrder, "TaskGraph runs on a paused pool");
+
+    TaskGraph failing;
+    atomic<bool> successorRan{false};
+    const auto root = failing.add_Node([](){ throw runtime_error("expected"); });
+    failing.add_Edge(root, failing.add_Node([&successorRan](){ successorRan = true; }));
+    bool thrown = false;
+    try {
+        failing.run(pool);
+    } catch (const runtime_error&) {
+        thrown = true;
+    }
+    check(thrown && !successorRan, "TaskGraph forwards exceptions and skips the remaining nodes");
+
+    TaskGraph cyclic;
+    const auto a = cyclic.add_Node([](){}), b = cyclic.add_Node([](){});
+    cyclic.add_Edge(a, b);
+    cyclic.add_Edge(b, a);
+    thrown = false;
+    try {
+        cyclic.run(pool);
+    } catch (const logic_error&) {
+        thrown = true;
+    }
+    check(thrown, "TaskGraph rejects a cycle");
+
+    pool.stop();
+    pool.wait_untilStopped();
+
+    graph.run(pool);
+    check(runs[0] == 102 && runs[LAYERS * WIDTH - 1] == 102 && inOrder, "TaskGraph runs on the calling thread if the pool is not running");
+}
+
+
+/*
+prints one line per test, ends with:
+
+ThreadPool test is successful!
+*/
+int main(int argc, const char** args) {
+    test_addBeforeStart();
+    test_manySmallTasks();
+    test_nestedWork();
+    test_pause();
+    test_submit();
+    test_brokenPromise();
+    test_parking();
+    test_parallelAlgorithms();
+    test_taskGroup();
+    test_taskGraph();
+    test_backpressure();
+    test_bulkSubmission();
+    test_priorities();
+    test_coroutines();
+    test_stats();
+    test_placement();
+    test_resize();
+    test_timers();
+
+    if (failures != 0){
+        cout << failures << " ThreadPool test(s) failed!" << endl;
+        return 1;
+    }
+    cout << "ThreadPool test is successful!" << endl;
+    return 0;
+}